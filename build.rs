@@ -16,7 +16,17 @@ fn main() {
     // Compile C files
     cc::Build::new()
         .file("src/image.c")
+        .file("src/media_file.c")
+        .file("src/planar_image.c")
         .file("src/argparse.c")
+        .file("src/arena.c")
+        .file("src/cell_grid.c")
+        .file("src/gif_decoder.c")
+        .file("src/convolve.c")
+        .file("src/frame_buffer.c")
+        .file("src/frame_pipeline.c")
+        .file("src/frame_scheduler.c")
+        .file("src/frame_store.c")
         .file("src/print_image.c")
         .include("include")
         .flag("-std=c99")
@@ -34,8 +44,9 @@ fn main() {
         .warnings(true)
         .compile("ascii_cpp");
 
-    // Link math library
+    // Link math and thread libraries
     println!("cargo:rustc-link-lib=m");
+    println!("cargo:rustc-link-lib=pthread");
     println!("cargo:rustc-link-lib=stdc++");
 
     // Set library search path
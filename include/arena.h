@@ -0,0 +1,54 @@
+/*
+ * ASCII Image Converter - Scratch Arena Header
+ *
+ * Copyright (c) 2025 danko12
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ASCIIVIEW_ARENA_H
+#define ASCIIVIEW_ARENA_H
+
+#include <stdlib.h>
+
+#define ARENA_ALIGNMENT 64
+
+typedef struct arena_overflow arena_overflow_t;
+
+// Bump allocator for per-frame scratch buffers. Requests that do not fit in
+// the main block go to overflow blocks; arena_reset() then replaces the main
+// block with one sized to the high-water mark, so a workload that repeats
+// stops touching the heap after its first cycle.
+typedef struct {
+    unsigned char* base;
+    size_t capacity;
+    size_t used;
+    size_t cycle_bytes;
+    size_t high_water;
+    arena_overflow_t* overflow;
+    size_t heap_allocations;
+} arena_t;
+
+void arena_init(arena_t* arena);
+void* arena_alloc(arena_t* arena, size_t size);
+void* arena_calloc(arena_t* arena, size_t count, size_t size);
+void arena_reset(arena_t* arena);
+void arena_free(arena_t* arena);
+
+#endif
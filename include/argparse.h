@@ -28,6 +28,12 @@
 #include <stdlib.h>
 #include <signal.h>
 
+typedef enum {
+    PLAYBACK_FORWARD = 0,
+    PLAYBACK_REVERSE,
+    PLAYBACK_PING_PONG,
+} playback_mode_t;
+
 typedef struct {
     char* file_path;
     size_t max_width;
@@ -36,17 +42,33 @@ typedef struct {
     double edge_threshold;
     int use_retro_colors;
     double sharpen_strength;
+    double sharpen_radius;
     int use_braille;
     int animate_gif;
     int dimension_preset;
     int use_grayscale;
     int debug_mode;
     int use_enhanced_palette;
+    int bench_mode;
+    int loop_count;
+    int full_refresh;
+    int gif_memory_mb;
+    int threads;
+    double speed;
+    double fps_cap;
+    int allow_frame_skip;
+    int fit_terminal;
+    int frame_first;            // --frames range, counted from 1; 0 for open-ended
+    int frame_last;
+    playback_mode_t playback;
+    double hysteresis;          // glyph hold margin in luminance, 0 to 1; 0 is off
+    int stable_contrast;
 } args_t;
 
 args_t parse_args(int argc, char* argv[]);
 void setup_signal_handlers(void);
 int terminal_was_resized(void);
+int try_get_terminal_size(size_t* width, size_t* height);
 
 extern volatile sig_atomic_t g_shutdown_requested;
 
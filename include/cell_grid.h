@@ -0,0 +1,83 @@
+/*
+ * ASCII Image Converter - Terminal Cell Grid Header
+ *
+ * Copyright (c) 2025 danko12
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ASCIIVIEW_CELL_GRID_H
+#define ASCIIVIEW_CELL_GRID_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "frame_buffer.h"
+
+// Longest cursor move: "\x1b[<row>;<col>H" with 20-digit coordinates
+#define CURSOR_MOVE_MAX_BYTES 44
+
+// One terminal cell: foreground color plus the UTF-8 bytes of its glyph.
+// Unused glyph bytes are zero, so two cells are equal iff their bytes are.
+typedef struct {
+    unsigned char rgb[3];
+    unsigned char length;
+    char glyph[GLYPH_MAX_BYTES];
+} cell_t;
+
+// Frame as the terminal shows it, row-major
+typedef struct {
+    size_t width;
+    size_t height;
+    cell_t* cells;
+    size_t heap_allocations;    // reallocations so far, kept across frees
+} cell_grid_t;
+
+void cell_grid_init(cell_grid_t* grid);
+int cell_grid_resize(cell_grid_t* grid, size_t width, size_t height);
+int cell_grid_copy(cell_grid_t* dst, const cell_grid_t* src);
+void cell_grid_free(cell_grid_t* grid);
+
+int cell_grid_encode_full(const cell_grid_t* grid, frame_buffer_t* output);
+int cell_grid_encode_delta(const cell_grid_t* previous, const cell_grid_t* current, frame_buffer_t* output);
+
+static inline cell_t* cell_grid_row(const cell_grid_t* grid, size_t y) {
+    return grid->cells + y * grid->width;
+}
+
+// Channels are clamped to 0..255. `glyph` holds GLYPH_MAX_BYTES bytes,
+// zero past `length`, so it is copied with a fixed size.
+static inline void cell_set(cell_t* cell, int r, int g, int b, const char glyph[GLYPH_MAX_BYTES], size_t length) {
+    cell->rgb[0] = (unsigned char) (r < 0 ? 0 : r > 255 ? 255 : r);
+    cell->rgb[1] = (unsigned char) (g < 0 ? 0 : g > 255 ? 255 : g);
+    cell->rgb[2] = (unsigned char) (b < 0 ? 0 : b > 255 ? 255 : b);
+    cell->length = (unsigned char) length;
+    memcpy(cell->glyph, glyph, GLYPH_MAX_BYTES);
+}
+
+static inline int cell_equal(const cell_t* a, const cell_t* b) {
+    return memcmp(a, b, sizeof(cell_t)) == 0;
+}
+
+static inline int cell_grid_equal(const cell_grid_t* a, const cell_grid_t* b) {
+    return a->width == b->width && a->height == b->height &&
+           (a->width * a->height == 0 || memcmp(a->cells, b->cells, a->width * a->height * sizeof(cell_t)) == 0);
+}
+
+#endif
@@ -0,0 +1,53 @@
+/*
+ * ASCII Image Converter - Content Hash Header
+ *
+ * Copyright (c) 2025 danko12
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ASCIIVIEW_CONTENT_HASH_H
+#define ASCIIVIEW_CONTENT_HASH_H
+
+#include <stdint.h>
+#include <string.h>
+
+// 64-bit hash of a byte range for spotting repeated frames: canvases and
+// encoded output. Eight bytes per step, with a final avalanche so that
+// nearby inputs land far apart. Never 0, which callers use for "unknown".
+static inline uint64_t content_hash(const void* data, size_t size) {
+    const unsigned char* bytes = data;
+    uint64_t hash = 0x9E3779B97F4A7C15ULL ^ (uint64_t) size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        hash = (hash ^ (word * 0xBF58476D1CE4E5B9ULL)) * 0x94D049BB133111EBULL;
+        hash ^= hash >> 29;
+    }
+    uint64_t tail = 0;
+    if (size > i) memcpy(&tail, bytes + i, size - i);
+    hash = (hash ^ tail) * 0xBF58476D1CE4E5B9ULL;
+    hash ^= hash >> 31;
+    hash *= 0x94D049BB133111EBULL;
+    hash ^= hash >> 32;
+    return hash ? hash : 1;
+}
+
+#endif
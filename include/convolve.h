@@ -0,0 +1,63 @@
+/*
+ * ASCII Image Converter - Convolution Engine Header
+ *
+ * Copyright (c) 2025 danko12
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef ASCIIVIEW_CONVOLVE_H
+#define ASCIIVIEW_CONVOLVE_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "image.h"
+
+// 3x3 convolution row kernels with SIMD variants picked at runtime from the
+// CPU's features, so release builds need no -march flags. Every variant
+// produces the same results as the scalar one.
+typedef enum {
+    CONVOLVE_SCALAR = 0,
+    CONVOLVE_SSE2,
+    CONVOLVE_AVX2,
+    CONVOLVE_AVX512,
+    CONVOLVE_VARIANT_COUNT
+} convolve_variant_t;
+
+// Float rows: writes out[1 .. width - 2] from rows y - 1, y and y + 1.
+void convolve_row_f32(const float* above, const float* row, const float* below,
+                      float* out, size_t width, const float kernel[9]);
+
+// Interleaved 8-bit rows with Q12 coefficients: writes the 32-bit
+// accumulators of samples [channels, (width - 1) * channels).
+void convolve_row_q12(const uint8_t* above, const uint8_t* row, const uint8_t* below,
+                      int32_t* out, size_t width, size_t channels, const int32_t kernel[9]);
+
+// Variant selection
+int convolve_variant_supported(convolve_variant_t variant);
+convolve_variant_t convolve_active_variant(void);
+void convolve_select_variant(convolve_variant_t variant);
+const char* convolve_variant_name(convolve_variant_t variant);
+
+// Reports per-variant throughput on an image (--bench)
+void convolve_run_bench(const image_t* image, int runs);
+
+#endif
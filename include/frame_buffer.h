@@ -0,0 +1,82 @@
+/*
+ * ASCII Image Converter - Frame Output Buffer Header
+ *
+ * Copyright (c) 2025 danko12
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ASCIIVIEW_FRAME_BUFFER_H
+#define ASCIIVIEW_FRAME_BUFFER_H
+
+#include <stdlib.h>
+#include <string.h>
+
+// Longest truecolor foreground sequence: "\x1b[38;2;255;255;255m"
+#define ANSI_FG_MAX_BYTES 19
+// Longest glyph: a 3-byte UTF-8 braille pattern
+#define GLYPH_MAX_BYTES 4
+
+// Escape sequences for one frame are encoded into a single buffer and
+// written out with one write() instead of a printf() per cell.
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+    size_t heap_allocations;    // reallocations so far, kept across frees
+} frame_buffer_t;
+
+// Decimal text of 0..255 (digits, then length in the last byte)
+extern char byte_decimal[256][4];
+
+void frame_buffer_init(frame_buffer_t* buffer);
+int frame_buffer_reserve(frame_buffer_t* buffer, size_t bytes);
+int frame_buffer_flush(frame_buffer_t* buffer, int fd);
+int frame_buffer_write(int fd, const char* data, size_t length);
+void frame_buffer_shrink(frame_buffer_t* buffer);
+void frame_buffer_free(frame_buffer_t* buffer);
+
+static inline void frame_buffer_reset(frame_buffer_t* buffer) {
+    buffer->length = 0;
+}
+
+// Appenders assume frame_buffer_reserve() made room for them
+static inline void frame_buffer_append(frame_buffer_t* buffer, const char* bytes, size_t length) {
+    memcpy(buffer->data + buffer->length, bytes, length);
+    buffer->length += length;
+}
+
+static inline void frame_buffer_put_byte(frame_buffer_t* buffer, unsigned char value) {
+    const char* decimal = byte_decimal[value];
+    memcpy(buffer->data + buffer->length, decimal, 3);
+    buffer->length += (size_t) decimal[3];
+}
+
+// Writes "\x1b[38;2;R;G;Bm"; channels are clamped to 0..255
+static inline void frame_buffer_put_fg(frame_buffer_t* buffer, int r, int g, int b) {
+    frame_buffer_append(buffer, "\x1b[38;2;", 7);
+    frame_buffer_put_byte(buffer, (unsigned char) (r < 0 ? 0 : r > 255 ? 255 : r));
+    buffer->data[buffer->length++] = ';';
+    frame_buffer_put_byte(buffer, (unsigned char) (g < 0 ? 0 : g > 255 ? 255 : g));
+    buffer->data[buffer->length++] = ';';
+    frame_buffer_put_byte(buffer, (unsigned char) (b < 0 ? 0 : b > 255 ? 255 : b));
+    buffer->data[buffer->length++] = 'm';
+}
+
+#endif
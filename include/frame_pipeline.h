@@ -0,0 +1,135 @@
+/*
+ * ASCII Image Converter - Frame Pipeline Header
+ *
+ * Copyright (c) 2025 danko12
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ASCIIVIEW_FRAME_PIPELINE_H
+#define ASCIIVIEW_FRAME_PIPELINE_H
+
+#include <pthread.h>
+
+#include "image.h"
+#include "arena.h"
+#include "argparse.h"
+#include "gif_decoder.h"
+
+// Frames prepared ahead of the one being shown, beyond one per worker
+#define FRAME_PIPELINE_AHEAD 3
+// Upper bound for the automatic worker count
+#define FRAME_PIPELINE_MAX_WORKERS 8
+// Distinct canvases kept prepared in full for reuse
+#define FRAME_PIPELINE_KEPT 16
+
+// A frame decoded, resized and sharpened for rendering. After the first
+// frame, only the cells that differ from the frame before are prepared, as
+// a patch to paste over it at (left, top). `image` points into the slot's
+// buffer, which is kept across frames at the largest size prepared so far,
+// or at a kept canvas with the frame's content hash.
+typedef struct {
+    image_t image;              // empty if the frame could not be decoded or nothing changed
+    pixel_t* buffer;
+    size_t capacity;            // samples `buffer` holds
+    size_t left, top;
+    int partial;                // `image` is a patch over the previous frame
+    int kept;                   // `image` is a kept canvas, not prepared again
+    uint64_t hash;              // content_hash() of the composed canvas, 0 if none
+    int frame;
+    int playable_frames;        // the source's count once this frame was composed
+    int ready;
+    size_t heap_allocations;    // made by the source and the worker preparing it
+} prepared_frame_t;
+
+// Frames one loop of playback shows, in order (--frames, --reverse, --ping-pong)
+typedef struct {
+    int* frames;
+    int length;
+} playback_order_t;
+
+// A whole prepared frame the player handed back, by its canvas's hash
+typedef struct {
+    uint64_t hash;
+    image_t image;
+} kept_canvas_t;
+
+typedef struct frame_pipeline frame_pipeline_t;
+
+typedef struct {
+    frame_pipeline_t* pipeline;
+    pthread_t thread;
+    arena_t scratch;
+    image_t canvas;             // private copy of the composed frame
+    gif_raster_t raster;        // LZW output decoded while waiting for the source
+    size_t heap_allocations;    // canvas copies and slot buffers allocated
+} pipeline_worker_t;
+
+// Prepares animation frames on worker threads so playback can start with the
+// first frame instead of waiting for all of them. Composition is sequential,
+// so workers take turns at the frame source in playback order, which the
+// source follows by seeking. While waiting
+// for its turn, a worker decodes its frame's LZW data; at its turn it only
+// composes. It then copies its canvas out, and resizes and sharpens in
+// parallel with the others.
+// Results fill a ring of slots in playback order, wrapping from the end of
+// the order to its start, and are identical for any worker count. If no thread
+// can be started, frames are prepared on demand by the caller instead.
+// Whole frames the player keeps (frame_pipeline_keep) are reused for any
+// later frame whose canvas hashes the same, in place of preparing it.
+struct frame_pipeline {
+    gif_source_t* source;       // owned by the workers while they run
+    const args_t* args;
+    const int* order;           // frames of one loop, NULL for every frame in order
+    int loop_length;
+    int frame_count;            // frames playable at start
+
+    pipeline_worker_t* workers;
+    int worker_slots;
+    int worker_count;           // threads running, 0 when preparing on demand
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    int stop;
+    long first;                 // position of the first frame to prepare
+    long claimed;               // frames handed to workers, counted across loops
+    long decoded;               // frames whose canvas has left the source
+    long consumed;              // frames released by the player
+    long limit;                 // frames to prepare in total, -1 for no limit
+    int depth;
+    prepared_frame_t* slots;
+    kept_canvas_t kept[FRAME_PIPELINE_KEPT];
+    int kept_count;             // written by the player under the lock
+    size_t heap_allocations;    // at start and by the frames released, for the player
+};
+
+int playback_order_init(playback_order_t* order, const args_t* args, int frame_count);
+void playback_order_free(playback_order_t* order);
+
+int frame_pipeline_default_workers(void);
+int frame_pipeline_start(frame_pipeline_t* pipeline, gif_source_t* source, const args_t* args,
+                         const playback_order_t* order, int workers, long first, long limit);
+const prepared_frame_t* frame_pipeline_next(frame_pipeline_t* pipeline);
+void frame_pipeline_release(frame_pipeline_t* pipeline);
+void frame_pipeline_keep(frame_pipeline_t* pipeline, uint64_t hash, const image_t* image);
+void frame_pipeline_extend(frame_pipeline_t* pipeline, long limit);
+void frame_pipeline_stop(frame_pipeline_t* pipeline);
+
+void frame_pipeline_run_bench(gif_source_t* source, const args_t* args, int max_workers);
+
+#endif
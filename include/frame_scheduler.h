@@ -0,0 +1,65 @@
+/*
+ * ASCII Image Converter - Frame Scheduler Header
+ *
+ * Copyright (c) 2025 danko12
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ASCIIVIEW_FRAME_SCHEDULER_H
+#define ASCIIVIEW_FRAME_SCHEDULER_H
+
+#include <time.h>
+
+// Shortest frame delay honored, as GIF delays of 0-1 centiseconds are
+// common placeholders rather than real timings
+#define FRAME_MIN_DELAY_MS 15
+
+// Paces animation frames against absolute CLOCK_MONOTONIC deadlines. Each
+// frame is due when the previous one's duration has elapsed since it was due,
+// so render and write time shorten the next wait instead of adding up.
+// With frame skipping, a frame whose whole display slot has already passed is
+// dropped; without it, a frame late by more than its own duration re-anchors
+// the schedule so later frames are not rushed.
+typedef struct {
+    double speed;
+    long long min_duration_ns;  // from the FPS cap, 0 for none
+    int allow_skip;
+    int started;
+    long long deadline_ns;      // when the next frame is due
+
+    // Achieved-vs-target timing
+    long long start_ns;
+    long long target_ns;        // total scheduled duration of the frames shown
+    long frames_shown;
+    long frames_dropped;
+    long resyncs;
+    double lateness_sum_ms;
+    double lateness_max_ms;
+} frame_scheduler_t;
+
+void frame_scheduler_init(frame_scheduler_t* scheduler, double speed, double fps_cap, int allow_skip);
+long long frame_scheduler_duration(const frame_scheduler_t* scheduler, int delay_ms);
+int frame_scheduler_should_drop(frame_scheduler_t* scheduler, long long duration_ns);
+void frame_scheduler_drop(frame_scheduler_t* scheduler, long long duration_ns);
+int frame_scheduler_wait(frame_scheduler_t* scheduler);
+void frame_scheduler_presented(frame_scheduler_t* scheduler, long long duration_ns);
+void frame_scheduler_report(const frame_scheduler_t* scheduler);
+
+#endif
@@ -0,0 +1,75 @@
+/*
+ * ASCII Image Converter - Packed Frame Store Header
+ *
+ * Copyright (c) 2025 danko12
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ASCIIVIEW_FRAME_STORE_H
+#define ASCIIVIEW_FRAME_STORE_H
+
+#include <stdint.h>
+
+#include "frame_buffer.h"
+#include "cell_grid.h"
+
+// Distinct glyphs a store can hold: glyph ids are one byte
+#define FRAME_STORE_GLYPHS 256
+#define FRAME_STORE_GLYPH_SLOTS 512
+
+typedef struct {
+    size_t offset;
+    size_t length;              // 0 if the frame is not stored
+    uint64_t key;               // caller's key for the patch, 0 for none
+} stored_frame_t;
+
+// Rendered animation frames kept as packed cells for replay. Each frame is
+// a patch over the frame played before it: runs of changed cells, 4 bytes
+// per cell (24-bit color and a glyph id). A frame whose predecessor had
+// another size, or none, is stored whole. Replay applies the patches in
+// playback order to rebuild each grid and encodes escape sequences from
+// there, so memory follows the cells that change rather than the ~20 bytes
+// of ANSI each cell costs. A frame whose patch has the same key and bytes as
+// an earlier one shares them.
+typedef struct {
+    frame_buffer_t data;        // patches back to back
+    stored_frame_t* frames;
+    int frame_count;
+    size_t heap_allocations;    // frame table reallocations
+    size_t cells;               // cells in the stored patches
+    size_t shared;              // frames stored as an earlier frame's patch
+    int glyph_count;
+    cell_t glyphs[FRAME_STORE_GLYPHS];              // color channels unused
+    uint16_t glyph_slots[FRAME_STORE_GLYPH_SLOTS];  // glyph id + 1 by glyph hash, 0 when empty
+} frame_store_t;
+
+int frame_store_init(frame_store_t* store, int frame_count);
+void frame_store_reset(frame_store_t* store, int frame_count);
+int frame_store_put(frame_store_t* store, int index, uint64_t key, const cell_grid_t* previous,
+                    const cell_grid_t* current);
+long frame_store_apply(const frame_store_t* store, int index, cell_grid_t* grid);
+void frame_store_shrink(frame_store_t* store);
+void frame_store_free(frame_store_t* store);
+
+static inline int frame_store_has(const frame_store_t* store, int index) {
+    return store->frames[index].length > 0;
+}
+
+#endif
@@ -0,0 +1,165 @@
+/*
+ * ASCII Image Converter - GIF Decoder Header
+ *
+ * Copyright (c) 2025 danko12
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ASCIIVIEW_GIF_DECODER_H
+#define ASCIIVIEW_GIF_DECODER_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "image.h"
+#include "media_file.h"
+
+// GIF canvases are always RGBA
+#define GIF_CHANNELS 4
+// Frames between composition snapshots once seeking is enabled
+#define GIF_KEYFRAME_INTERVAL 16
+
+typedef struct gif_lzw_entry gif_lzw_entry_t;
+
+// Where one frame's data lives in the file, and the graphic control state it
+// is drawn with. Filled by a scan of the block structure, without decoding.
+typedef struct {
+    size_t raster_offset;       // LZW minimum code size byte
+    size_t palette_offset;      // local color table, 0 to use the global one
+    int palette_size;
+    int left, top, width, height;
+    int interlaced;
+    int control_flags;          // graphic control flags in effect
+    int transparent;            // transparent index in effect, -1 for none
+    int delay;                  // milliseconds: 10 x the centisecond field
+
+    // Bounding box [left, right) x [top, bottom) of the canvas pixels that
+    // differ from the frame before, the last frame for frame 0. The whole
+    // canvas until composing the frame after its predecessor has shown less.
+    int changed_left, changed_top, changed_right, changed_bottom;
+
+    // content_hash() of the composed canvas, 0 until it is composed. Frames
+    // with equal hashes show the same picture wherever they are played.
+    uint64_t hash;
+} gif_frame_info_t;
+
+// One frame's LZW output: palette indices in stream order. Decoding depends
+// only on the file, so rasters can be decoded on any thread, ahead of the
+// sequential composition that consumes them.
+typedef struct {
+    int frame;                  // -1 while empty
+    long count;                 // indices decoded, -1 for a corrupt stream
+    unsigned char* indices;
+    gif_lzw_entry_t* table;
+} gif_raster_t;
+
+// Composition state just before a frame is drawn, run-length coded: the
+// canvas after the previous frame's disposal and, when this frame restores
+// to previous, the canvas before that disposal. Composition can resume from
+// it instead of from the first frame.
+typedef struct {
+    unsigned char* canvas;      // NULL until the frame has been composed once
+    size_t canvas_size;
+    unsigned char* previous;    // NULL unless this frame restores to previous
+    size_t previous_size;
+} gif_keyframe_t;
+
+// Sequential GIF decoder over a mapped file. Opening indexes every frame;
+// gif_decoder_next() then decodes and composes one frame at a time onto a
+// single RGBA canvas, so memory does not depend on the frame count.
+// Composition follows stb_image's rules for disposal and transparency.
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+    int width;
+    int height;
+    int background_index;
+    int has_global_palette;
+    unsigned char global_palette[256][4];
+    int frame_count;
+    gif_frame_info_t* frames;
+    int playable_frames;        // frames before the first corrupt one found
+    int restores_previous;      // some frame uses "restore to previous" disposal
+
+    // Composition state
+    int next_frame;
+    unsigned char* canvas;
+    unsigned char* background;
+    unsigned char* history;
+    unsigned char* previous[2]; // canvases after the last two frames
+    unsigned char* before;      // pixels a frame may change, as they were
+    int composed;               // frame on the canvas, -1 for none
+    gif_raster_t raster;        // LZW output of the current frame
+
+    // Seek index, one snapshot per GIF_KEYFRAME_INTERVAL frames, taken the
+    // first time each is composed. NULL unless seeking is enabled. Once the
+    // snapshots outgrow `keyframe_budget`, every other one is dropped and
+    // `keyframe_spacing` doubles.
+    gif_keyframe_t* keyframes;
+    size_t keyframe_bytes;
+    size_t keyframe_budget;
+    int keyframe_spacing;
+    size_t heap_allocations;    // snapshot buffers allocated
+} gif_decoder_t;
+
+int gif_raster_init(gif_raster_t* raster, const gif_decoder_t* decoder);
+void gif_raster_decode(gif_raster_t* raster, const gif_decoder_t* decoder, int index);
+void gif_raster_free(gif_raster_t* raster);
+
+int gif_decoder_open(gif_decoder_t* decoder, const media_file_t* file);
+const unsigned char* gif_decoder_next(gif_decoder_t* decoder, const gif_raster_t* decoded);
+void gif_decoder_rewind(gif_decoder_t* decoder);
+int gif_decoder_enable_seek(gif_decoder_t* decoder, size_t budget);
+void gif_decoder_seek(gif_decoder_t* decoder, int index);
+void gif_decoder_close(gif_decoder_t* decoder);
+
+// A composed frame held in the frame source's window
+typedef struct {
+    image_t canvas;
+    int frame;                  // -1 while empty
+    unsigned long last_used;
+} gif_window_slot_t;
+
+// On-demand frame source. Composed canvases are kept in an LRU window sized
+// to a memory cap; frames outside it are decoded again when requested, from
+// the decoder's position or, for earlier frames, from the start or the
+// nearest keyframe when seeking is enabled. One thread
+// at a time requests frames; `window_lock` only lets others ask which frames
+// the window holds.
+typedef struct {
+    gif_decoder_t decoder;
+    pthread_mutex_t window_lock;
+    gif_window_slot_t* window;
+    int window_size;
+    unsigned long clock;
+    size_t decoded_frames;
+    size_t memory_cap;
+    size_t heap_allocations;    // window canvases allocated
+} gif_source_t;
+
+int gif_source_open(gif_source_t* source, const media_file_t* file, size_t memory_cap);
+int gif_source_enable_seek(gif_source_t* source);
+const image_t* gif_source_frame(gif_source_t* source, int index, const gif_raster_t* decoded);
+int gif_source_holds(gif_source_t* source, int index);
+void gif_source_flush(gif_source_t* source);
+void gif_source_close(gif_source_t* source);
+
+#endif
@@ -27,43 +27,67 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "media_file.h"
+
+// Pixel storage. Channels are stored as 8-bit values and the kernels use
+// fixed-point arithmetic. Building with ASCIIVIEW_DOUBLE_PIXELS keeps the
+// original double-precision pipeline (values in [0., 1.]) as a reference.
+#ifdef ASCIIVIEW_DOUBLE_PIXELS
+typedef double pixel_t;
+typedef double pixel_sum_t;
+#define PIXEL_MAX 1.0
+#define PIXEL_FROM_BYTE(v) ((v) / 255.0)
+#define PIXEL_TO_UNIT(v) ((double) (v))
+#define PIXEL_FROM_SUM(sum, n) ((sum) / (double) (n))
+#else
+typedef uint8_t pixel_t;
+typedef uint64_t pixel_sum_t;
+#define PIXEL_MAX 255
+#define PIXEL_FROM_BYTE(v) ((pixel_t) (v))
+#define PIXEL_TO_UNIT(v) ((v) * (1.0 / 255.0))
+#define PIXEL_FROM_SUM(sum, n) ((pixel_t) (((sum) + (n) / 2) / (n)))
+#endif
 
 typedef struct {
     size_t width;
     size_t height;
     size_t channels;
-    double* data;
+    pixel_t* data;
 } image_t;
 
 // Image loading and management
-image_t load_image(const char* file_path);
+image_t load_image(const media_file_t* file);
 void free_image(image_t* image);
 
 // Image transformations
+void get_resized_dimensions(size_t source_width, size_t source_height, size_t max_width, size_t max_height,
+                            double character_ratio, size_t* out_width, size_t* out_height);
+void get_resize_span(size_t index, size_t out_size, size_t in_size, size_t* start, size_t* end);
 image_t make_resized(image_t* original, size_t max_width, size_t max_height, double character_ratio);
+image_t make_resized_region(const image_t* original, size_t width, size_t height,
+                            size_t left, size_t top, size_t right, size_t bottom);
+int resize_region_into(const image_t* original, size_t width, size_t height,
+                       size_t left, size_t top, size_t right, size_t bottom, pixel_t* data, arena_t* scratch);
+void paste_image(image_t* image, const image_t* patch, size_t left, size_t top);
 image_t make_grayscale(image_t* original);
 
 // Pixel operations
-double* get_pixel(image_t* image, size_t x, size_t y);
-void set_pixel(image_t* image, size_t x, size_t y, const double* new_pixel);
+pixel_t* get_pixel(image_t* image, size_t x, size_t y);
+void set_pixel(image_t* image, size_t x, size_t y, const pixel_t* new_pixel);
+pixel_t pixel_grayscale(const pixel_t* pixel, size_t channels);
 
 // Edge detection
 void get_convolution(image_t* image, double* kernel, double* out);
 void get_sobel(image_t* image, double* out_x, double* out_y);
 
-// Image enhancement
-void sharpen_image(image_t* image, double strength);
-void unsharp_mask(image_t* image, double amount, double radius);
-
-// GIF animation support
-typedef struct {
-    int frame_count;
-    int* delays;
-    image_t* frames;
-} gif_animation_t;
-
-int is_gif_file(const char* file_path);
-gif_animation_t load_gif_animation(const char* file_path);
-void free_gif_animation(gif_animation_t* anim);
+// Image enhancement. Temporaries come from `scratch` when given (released
+// by the caller's arena_reset), otherwise from the heap.
+void sharpen_image(image_t* image, double strength, arena_t* scratch);
+void unsharp_mask(image_t* image, double amount, double radius, arena_t* scratch);
+void get_box_blur_radii(double sigma, size_t radii[3]);
+size_t unsharp_mask_halo(double radius);
 
 #endif
@@ -0,0 +1,55 @@
+/*
+ * ASCII Image Converter - Media File Input Header
+ *
+ * Copyright (c) 2025 danko12
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef ASCIIVIEW_MEDIA_FILE_H
+#define ASCIIVIEW_MEDIA_FILE_H
+
+#include <stdlib.h>
+
+typedef enum {
+    MEDIA_FORMAT_UNKNOWN = 0,
+    MEDIA_FORMAT_GIF,
+    MEDIA_FORMAT_PNG,
+    MEDIA_FORMAT_JPEG,
+    MEDIA_FORMAT_BMP,
+    MEDIA_FORMAT_PNM,
+} media_format_t;
+
+// Input file opened once and memory-mapped read-only. Decoders read straight
+// from `data`; the format is sniffed from the leading bytes. Files that cannot
+// be mapped (pipes, character devices) are read into a heap buffer instead.
+typedef struct {
+    const char* path;
+    const unsigned char* data;
+    size_t size;
+    media_format_t format;
+    int mapped;
+} media_file_t;
+
+int media_file_open(media_file_t* file, const char* path);
+void media_file_close(media_file_t* file);
+media_format_t media_probe_format(const unsigned char* data, size_t size);
+
+#endif
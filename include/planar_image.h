@@ -0,0 +1,70 @@
+/*
+ * ASCII Image Converter - Planar Float Image Header
+ *
+ * Copyright (c) 2025 danko12
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef ASCIIVIEW_PLANAR_IMAGE_H
+#define ASCIIVIEW_PLANAR_IMAGE_H
+
+#include <stdlib.h>
+
+#include "image.h"
+
+// Planes and rows start on 64-byte boundaries (one cache line, one AVX-512 vector)
+#define PLANAR_ALIGNMENT 64
+#define PLANAR_MAX_CHANNELS 4
+
+// Planar (structure-of-arrays) working format. Each channel is a separate
+// float plane with values in [0., 1.]; rows are padded to `stride` floats so
+// every row starts aligned and unit-stride inner loops vectorize cleanly.
+typedef struct {
+    size_t width;
+    size_t height;
+    size_t channels;
+    size_t stride;
+    float* planes[PLANAR_MAX_CHANNELS];
+    float* storage;
+} planar_image_t;
+
+// Gets pointer to the start of row y in channel c
+static inline float* planar_row(const planar_image_t* image, size_t c, size_t y) {
+    return image->planes[c] + y * image->stride;
+}
+
+// Allocation and conversion at pipeline boundaries
+planar_image_t make_planar_blank(size_t width, size_t height, size_t channels);
+planar_image_t make_planar_scratch(arena_t* scratch, size_t width, size_t height, size_t channels);
+planar_image_t make_planar(const image_t* image);
+image_t make_interleaved(const planar_image_t* planar);
+void free_planar(planar_image_t* planar);
+
+// Kernels
+planar_image_t make_planar_resized(const planar_image_t* original, size_t width, size_t height);
+planar_image_t make_planar_sharpened_resized(const image_t* original, size_t width, size_t height,
+                                             float amount, float radius);
+void planar_sharpen(planar_image_t* image, float strength);
+void planar_unsharp_mask(planar_image_t* image, float amount, float radius);
+void planar_sobel(const planar_image_t* image, size_t channel, planar_image_t* gradients);
+void planar_sobel_row(const float* above, const float* row, const float* below,
+                      float* out_x, float* out_y, size_t width);
+
+#endif
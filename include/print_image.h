@@ -25,10 +25,69 @@
 #ifndef ASCIIVIEW_PRINT_IMAGE_H
 #define ASCIIVIEW_PRINT_IMAGE_H
 
+#include <stdint.h>
+
 #include "image.h"
+#include "arena.h"
+#include "frame_buffer.h"
+#include "cell_grid.h"
 #include "argparse.h"
+#include "gif_decoder.h"
+#include "frame_pipeline.h"
+
+// Temporal hysteresis for animations: a cell keeps the glyph and color it
+// has on screen until its luminance moves more than `margin` away from the
+// value that chose them, or a color channel more than margin * 255 away.
+// Glyphs near a ramp threshold then stop flickering between frames. The
+// side buffer holds that luminance per cell, 16 bits each.
+typedef struct {
+    double margin;              // 0 turns it off
+    size_t width;
+    size_t height;
+    uint16_t* anchors;
+    cell_grid_t raw;            // cells as rendered before holding, to count raw changes
+    int count_raw;
+    size_t heap_allocations;    // anchor buffers allocated
+    size_t frames;              // frames rendered against a previous grid of their size
+    size_t changed;             // cells that differ from the previous frame shown
+    size_t changed_raw;         // cells that would have differed without hysteresis
+} glyph_hysteresis_t;
+
+// Equalization carried across animation frames (--stable-contrast). Each
+// frame's histogram is sampled on a sparse grid and folded into an
+// exponential average, and the curve comes from the averaged CDF, so global
+// brightness drifts instead of pumping with every frame. A frame whose
+// histogram is far from the average is a scene cut and restarts it.
+typedef struct {
+    int enabled;
+    int primed;
+    double histogram[256];      // averaged, normalized to sum to 1
+    size_t frames;
+    size_t scene_cuts;
+    double curve[256];          // last frame's curve, to measure how far it moves
+    double curve_raw[256];      // last frame's own curve, as equalized without averaging
+    double drift;               // summed per-frame curve moves, weighted by the frame's histogram
+    double drift_raw;
+} contrast_history_t;
+
+// Reusable rendering state. Scratch buffers come from the arena, which is
+// reset per frame and settles at the high-water mark, so rendering frames of
+// a steady size does not allocate. A frame is rendered into `cells` and
+// encoded from there to `output`. Glyph hysteresis and stable contrast carry
+// over between frames.
+typedef struct {
+    arena_t scratch;
+    cell_grid_t cells;
+    frame_buffer_t output;
+    glyph_hysteresis_t hysteresis;
+    contrast_history_t contrast;
+} render_context_t;
+
+void render_context_init(render_context_t* ctx);
+void render_context_free(render_context_t* ctx);
 
 void print_image(image_t* image, double edge_threshold, int use_retro_colors, int use_braille, int use_grayscale);
-void play_gif_animation(gif_animation_t* anim, args_t* args);
+void print_image_with_options(render_context_t* ctx, image_t* image, args_t* args);
+void play_gif_animation(gif_source_t* source, args_t* args);
 
 #endif
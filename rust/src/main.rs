@@ -31,6 +31,9 @@ struct Args {
 
     #[arg(short = 'l', long = "loop-playback")]
     loop_playback: bool,
+
+    #[arg(long = "speed")]
+    speed: Option<f32>,
 }
 
 fn main() {
@@ -60,14 +63,27 @@ fn main() {
         println!("   Redirecting to optimized C/C++ processor...");
         println!();
         
+        // Playback timing is handled by the C frame scheduler
+        let mut timing: Vec<String> = Vec::new();
+        if let Some(fps) = args.fps {
+            timing.extend(["--fps".to_string(), fps.to_string()]);
+        }
+        if let Some(speed) = args.speed {
+            timing.extend(["--speed".to_string(), speed.to_string()]);
+        }
+        if args.allow_frame_skip {
+            timing.push("--allow-frame-skip".to_string());
+        }
+
         let status = process::Command::new("./ascii")
             .arg(&media)
             .args(if args.grayscale { vec!["--grayscale"] } else { vec![] })
             .args(if args.loop_playback && (media.ends_with(".gif") || media.ends_with(".GIF")) { 
-                vec!["--animate"] 
+                vec!["--animate", "--loop", "0"] 
             } else { 
                 vec![] 
             })
+            .args(&timing)
             .status();
 
         match status {
@@ -106,6 +122,10 @@ fn print_usage() {
     println!("    --grayscale      Black & white mode");
     println!("    --animate        Play GIF animations");
     println!("    --braille        Use braille characters (high detail)");
+    println!("    --loop <count>   Animation loops, 0 = forever (default: 3)");
+    println!("    --speed <x>      Animation speed multiplier (default: 1.0)");
+    println!("    --fps <n>        Cap animation frame rate");
+    println!("    --allow-frame-skip  Drop frames that fall behind schedule");
     println!("    --help           Show full help message");
     println!();
     println!("CURRENT FEATURES (v3.0.0):");
@@ -0,0 +1,123 @@
+/*
+ * ASCII Image Converter - Scratch Arena
+ *
+ * Copyright (c) 2025 danko12
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../include/arena.h"
+
+// Overflow blocks keep their header in the first aligned slot
+struct arena_overflow {
+    arena_overflow_t* next;
+};
+
+
+static size_t align_up(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1);
+}
+
+
+static void* aligned_block(arena_t* arena, size_t size) {
+    void* ptr = NULL;
+    if (posix_memalign(&ptr, ARENA_ALIGNMENT, size) != 0) {
+        return NULL;
+    }
+    arena->heap_allocations++;
+    return ptr;
+}
+
+
+void arena_init(arena_t* arena) {
+    memset(arena, 0, sizeof(*arena));
+}
+
+
+// Returns ARENA_ALIGNMENT-aligned, uninitialized memory valid until the next reset
+void* arena_alloc(arena_t* arena, size_t size) {
+    size = align_up(size ? size : 1);
+    arena->cycle_bytes += size;
+    if (arena->cycle_bytes > arena->high_water) {
+        arena->high_water = arena->cycle_bytes;
+    }
+
+    if (arena->used + size <= arena->capacity) {
+        void* ptr = arena->base + arena->used;
+        arena->used += size;
+        return ptr;
+    }
+
+    // Main block exhausted: serve from an overflow block until the next reset
+    unsigned char* block = aligned_block(arena, ARENA_ALIGNMENT + size);
+    if (!block) {
+        fprintf(stderr, "Error: Failed to allocate scratch memory!\n");
+        return NULL;
+    }
+    arena_overflow_t* overflow = (arena_overflow_t*) block;
+    overflow->next = arena->overflow;
+    arena->overflow = overflow;
+
+    return block + ARENA_ALIGNMENT;
+}
+
+
+void* arena_calloc(arena_t* arena, size_t count, size_t size) {
+    void* ptr = arena_alloc(arena, count * size);
+    if (ptr) {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+
+static void free_overflow(arena_t* arena) {
+    while (arena->overflow) {
+        arena_overflow_t* next = arena->overflow->next;
+        free(arena->overflow);
+        arena->overflow = next;
+    }
+}
+
+
+// Releases everything allocated since the last reset
+void arena_reset(arena_t* arena) {
+    int overflowed = arena->overflow != NULL;
+    free_overflow(arena);
+
+    // Grow the main block once so the next cycle fits without overflow
+    if (overflowed && arena->high_water > arena->capacity) {
+        free(arena->base);
+        arena->base = aligned_block(arena, arena->high_water);
+        arena->capacity = arena->base ? arena->high_water : 0;
+    }
+
+    arena->used = 0;
+    arena->cycle_bytes = 0;
+}
+
+
+void arena_free(arena_t* arena) {
+    free_overflow(arena);
+    free(arena->base);
+    arena_init(arena);
+}
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <limits.h>
 
 #include <sys/ioctl.h>
 #include <unistd.h>
@@ -54,6 +55,10 @@ static void sigint_handler(int sig) {
 #define DEFAULT_CHARACTER_RATIO 2.0
 #define DEFAULT_EDGE_THRESHOLD 4.0
 #define DEFAULT_SHARPEN_STRENGTH 0.0
+#define DEFAULT_SHARPEN_RADIUS 1.0
+#define DEFAULT_LOOP_COUNT 3
+#define DEFAULT_FULL_REFRESH 100
+#define DEFAULT_GIF_MEMORY_MB 64
 #define VERSION "3.0.0"
 
 // Dimension Presets (Width x Height)
@@ -127,12 +132,27 @@ void print_help(char* exec_alias) {
     printf("\t-et <threshold>\t\tEdge detection threshold, range: 0.0 - 4.0 (default: %.1f, disabled)\n", DEFAULT_EDGE_THRESHOLD);
     printf("\t-cr <ratio>\t\tHeight-to-width ratio for characters (default: %.1f)\n", DEFAULT_CHARACTER_RATIO);
     printf("\t-s, --sharpen <strength>\tSharpening strength, range: 0.0 - 2.0 (default: %.1f, disabled)\n", DEFAULT_SHARPEN_STRENGTH);
+    printf("\t--sharpen-radius <px>\tSharpening blur radius in source pixels, output cells for GIFs (default: %.1f)\n", DEFAULT_SHARPEN_RADIUS);
     printf("\t--retro-colors\t\tUse 3-bit retro color palette (8 colors) instead of 24-bit truecolor\n");
     printf("\t--braille\t\tUse braille characters for higher detail (experimental)\n");
     printf("\t--animate\t\tAnimate GIF files (if supported)\n");
+    printf("\t--loop <count>\t\tTimes to play an animation, 0 = forever (default: %d)\n", DEFAULT_LOOP_COUNT);
+    printf("\t--full-refresh <n>\tRedraw every cell each n animation frames, 1 = always, 0 = never (default: %d)\n", DEFAULT_FULL_REFRESH);
+    printf("\t--gif-memory <MB>\tMemory for decoded and encoded animation frames (default: %d)\n", DEFAULT_GIF_MEMORY_MB);
+    printf("\t--speed <x>\t\tAnimation speed multiplier (default: 1.0)\n");
+    printf("\t--fps <n>\t\tCap animation frame rate, 0 = GIF timing only (default: 0)\n");
+    printf("\t--allow-frame-skip\tDrop animation frames that fall behind schedule\n");
+    printf("\t--frames <a:b>\t\tPlay only frames a to b, counted from 1; either end may be left out\n");
+    printf("\t--reverse\t\tPlay the animation backwards\n");
+    printf("\t--ping-pong\t\tPlay the animation forwards, then backwards\n");
+    printf("\t--hysteresis <m>\tHold animation cells until luminance moves by more than m, 0 to 1 (default: 0)\n");
+    printf("\t--stable-contrast\tEqualize animations with a curve averaged over frames, reset on scene cuts\n");
+    printf("\t--threads <n>\t\tWorkers preparing animation frames, 0 = one per core (default: 0)\n");
     printf("\t--grayscale\t\tConvert image/GIF to black and white (grayscale mode)\n");
     printf("\t--enhanced-palette\tUse 70+ character precision palette for maximum detail\n");
     printf("\t--debug\t\t\tEnable debug mode with real-time stats (FPS, terminal size, etc)\n");
+    printf("\t--bench\t\t\tBenchmark the convolution variants on the image and exit\n");
+    printf("\t\t\t\tWith --animate: benchmark GIF decoding and frame preparation on 1 to --threads workers\n");
     printf("\t-h, --help\t\tShow this help message\n");
     printf("\t-v, --version\t\tShow version information\n");
     printf("\nNOTE: -D preset overrides -mw and -mh values. Use -mw/-mh for custom dimensions.\n");
@@ -187,6 +207,27 @@ int try_get_terminal_size(size_t* width, size_t* height) {
 }
 
 
+// Parses "a:b", "a:" or ":b" with 1 <= a <= b. Returns 0 if malformed.
+static int parse_frame_range(const char* text, int* first, int* last) {
+    const char* colon = strchr(text, ':');
+    if (!colon) return 0;
+
+    char* end;
+    *first = *last = 0;
+    if (colon != text) {
+        long value = strtol(text, &end, 10);
+        if (end != colon || value < 1 || value > INT_MAX) return 0;
+        *first = (int) value;
+    }
+    if (colon[1] != '\0') {
+        long value = strtol(colon + 1, &end, 10);
+        if (*end != '\0' || value < 1 || value > INT_MAX) return 0;
+        *last = (int) value;
+    }
+    return *last == 0 || *first <= *last;
+}
+
+
 args_t parse_args(int argc, char* argv[]) {
     // Get variable defaults
     args_t args = {
@@ -197,18 +238,34 @@ args_t parse_args(int argc, char* argv[]) {
         .edge_threshold = DEFAULT_EDGE_THRESHOLD,
         .use_retro_colors = 0,
         .sharpen_strength = DEFAULT_SHARPEN_STRENGTH,
+        .sharpen_radius = DEFAULT_SHARPEN_RADIUS,
         .use_braille = 0,
         .animate_gif = 0,
         .dimension_preset = 0,
         .use_grayscale = 0,
         .debug_mode = 0,
         .use_enhanced_palette = 0,
+        .bench_mode = 0,
+        .loop_count = DEFAULT_LOOP_COUNT,
+        .full_refresh = DEFAULT_FULL_REFRESH,
+        .gif_memory_mb = DEFAULT_GIF_MEMORY_MB,
+        .threads = 0,
+        .speed = 1.0,
+        .fps_cap = 0.0,
+        .allow_frame_skip = 0,
+        .fit_terminal = 0,
+        .frame_first = 0,
+        .frame_last = 0,
+        .playback = PLAYBACK_FORWARD,
+        .hysteresis = 0.0,
+        .stable_contrast = 0,
     };
     
     // Setup signal handlers for resize and shutdown
     setup_signal_handlers();
 
-    try_get_terminal_size(&args.max_width, &args.max_height);
+    // Without -D, -mw or -mh the size follows the terminal, also on resize
+    args.fit_terminal = try_get_terminal_size(&args.max_width, &args.max_height);
 
     // If no file given
     if (argc == 1) {
@@ -232,29 +289,106 @@ args_t parse_args(int argc, char* argv[]) {
         if (!strcmp(argv[i], "-D") && i + 1 < (size_t) argc) {
             args.dimension_preset = atoi(argv[++i]);
             apply_dimension_preset(&args, args.dimension_preset);
+            args.fit_terminal = 0;
         }
-        else if (!strcmp(argv[i], "-mw") && i + 1 < (size_t) argc)
+        else if (!strcmp(argv[i], "-mw") && i + 1 < (size_t) argc) {
             args.max_width = (size_t) atoi(argv[++i]);
-        else if (!strcmp(argv[i], "-mh") && i + 1 < (size_t) argc)
+            args.fit_terminal = 0;
+        }
+        else if (!strcmp(argv[i], "-mh") && i + 1 < (size_t) argc) {
             args.max_height = (size_t) atoi(argv[++i]);
+            args.fit_terminal = 0;
+        }
         else if (!strcmp(argv[i], "-et") && i + 1 < (size_t) argc)
             args.edge_threshold = atof(argv[++i]);
         else if (!strcmp(argv[i], "-cr") && i + 1 < (size_t) argc)
             args.character_ratio = atof(argv[++i]);
         else if ((!strcmp(argv[i], "-s") || !strcmp(argv[i], "--sharpen")) && i + 1 < (size_t) argc)
             args.sharpen_strength = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--sharpen-radius") && i + 1 < (size_t) argc) {
+            args.sharpen_radius = atof(argv[++i]);
+            if (args.sharpen_radius <= 0.0) {
+                fprintf(stderr, "Warning: Invalid sharpen radius. Using default.\n");
+                args.sharpen_radius = DEFAULT_SHARPEN_RADIUS;
+            }
+        }
         else if (!strcmp(argv[i], "--retro-colors"))
             args.use_retro_colors = 1;
         else if (!strcmp(argv[i], "--braille"))
             args.use_braille = 1;
         else if (!strcmp(argv[i], "--animate"))
             args.animate_gif = 1;
+        else if (!strcmp(argv[i], "--loop") && i + 1 < (size_t) argc) {
+            args.loop_count = atoi(argv[++i]);
+            if (args.loop_count < 0) {
+                fprintf(stderr, "Warning: Invalid loop count. Using default.\n");
+                args.loop_count = DEFAULT_LOOP_COUNT;
+            }
+        }
+        else if (!strcmp(argv[i], "--full-refresh") && i + 1 < (size_t) argc) {
+            args.full_refresh = atoi(argv[++i]);
+            if (args.full_refresh < 0) {
+                fprintf(stderr, "Warning: Invalid full refresh interval. Using default.\n");
+                args.full_refresh = DEFAULT_FULL_REFRESH;
+            }
+        }
+        else if (!strcmp(argv[i], "--gif-memory") && i + 1 < (size_t) argc) {
+            args.gif_memory_mb = atoi(argv[++i]);
+            if (args.gif_memory_mb <= 0) {
+                fprintf(stderr, "Warning: Invalid GIF memory limit. Using default.\n");
+                args.gif_memory_mb = DEFAULT_GIF_MEMORY_MB;
+            }
+        }
+        else if (!strcmp(argv[i], "--speed") && i + 1 < (size_t) argc) {
+            args.speed = atof(argv[++i]);
+            if (!(args.speed > 0.0)) {
+                fprintf(stderr, "Warning: Invalid speed. Using 1.0.\n");
+                args.speed = 1.0;
+            }
+        }
+        else if (!strcmp(argv[i], "--fps") && i + 1 < (size_t) argc) {
+            args.fps_cap = atof(argv[++i]);
+            if (!(args.fps_cap >= 0.0)) {
+                fprintf(stderr, "Warning: Invalid FPS cap. Using none.\n");
+                args.fps_cap = 0.0;
+            }
+        }
+        else if (!strcmp(argv[i], "--allow-frame-skip"))
+            args.allow_frame_skip = 1;
+        else if (!strcmp(argv[i], "--frames") && i + 1 < (size_t) argc) {
+            if (!parse_frame_range(argv[++i], &args.frame_first, &args.frame_last)) {
+                fprintf(stderr, "Warning: Invalid frame range '%s'. Playing all frames.\n", argv[i]);
+                args.frame_first = args.frame_last = 0;
+            }
+        }
+        else if (!strcmp(argv[i], "--reverse"))
+            args.playback = PLAYBACK_REVERSE;
+        else if (!strcmp(argv[i], "--ping-pong"))
+            args.playback = PLAYBACK_PING_PONG;
+        else if (!strcmp(argv[i], "--hysteresis") && i + 1 < (size_t) argc) {
+            args.hysteresis = atof(argv[++i]);
+            if (!(args.hysteresis >= 0.0 && args.hysteresis <= 1.0)) {
+                fprintf(stderr, "Warning: Invalid hysteresis margin. Turning it off.\n");
+                args.hysteresis = 0.0;
+            }
+        }
+        else if (!strcmp(argv[i], "--stable-contrast"))
+            args.stable_contrast = 1;
+        else if (!strcmp(argv[i], "--threads") && i + 1 < (size_t) argc) {
+            args.threads = atoi(argv[++i]);
+            if (args.threads < 0) {
+                fprintf(stderr, "Warning: Invalid thread count. Using one per core.\n");
+                args.threads = 0;
+            }
+        }
         else if (!strcmp(argv[i], "--grayscale"))
             args.use_grayscale = 1;
         else if (!strcmp(argv[i], "--enhanced-palette"))
             args.use_enhanced_palette = 1;
         else if (!strcmp(argv[i], "--debug"))
             args.debug_mode = 1;
+        else if (!strcmp(argv[i], "--bench"))
+            args.bench_mode = 1;
         else if (!strcmp(argv[i], "-h") || !strcmp(argv[i], "--help")) {
             print_help(argv[0]);
             args.file_path = NULL;
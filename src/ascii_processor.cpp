@@ -33,7 +33,7 @@
 namespace ascii {
 
 // sRGB gamma correction
-inline double srgb_to_linear(double channel) {
+inline double srgb_to_linear_exact(double channel) {
     if (channel <= 0.04045) {
         return channel / 12.92;
     } else {
@@ -41,7 +41,7 @@ inline double srgb_to_linear(double channel) {
     }
 }
 
-inline double linear_to_srgb(double channel) {
+inline double linear_to_srgb_exact(double channel) {
     if (channel <= 0.0031308) {
         return 12.92 * channel;
     } else {
@@ -49,6 +49,54 @@ inline double linear_to_srgb(double channel) {
     }
 }
 
+// Both transfer curves sampled on a uniform grid over [0, 1]. Linear
+// interpolation between samples stays within 1e-7 of the exact curve for
+// srgb_to_linear and within 2e-5 for linear_to_srgb (worst just above its
+// linear toe), both far below one 8-bit step of 1/255.
+constexpr size_t kTransferSteps = 4096;
+
+struct TransferTables {
+    double to_linear[kTransferSteps + 1];
+    double to_srgb[kTransferSteps + 1];
+
+    TransferTables() {
+        for (size_t i = 0; i <= kTransferSteps; i++) {
+            double x = static_cast<double>(i) / kTransferSteps;
+            to_linear[i] = srgb_to_linear_exact(x);
+            to_srgb[i] = linear_to_srgb_exact(x);
+        }
+    }
+};
+
+inline const TransferTables& transfer_tables() {
+    static const TransferTables tables;
+    return tables;
+}
+
+inline double interpolate_transfer(const double* table, double x) {
+    double position = x * kTransferSteps;
+    size_t index = static_cast<size_t>(position);
+    if (index >= kTransferSteps) {
+        index = kTransferSteps - 1;
+    }
+    double fraction = position - static_cast<double>(index);
+    return table[index] + (table[index + 1] - table[index]) * fraction;
+}
+
+inline double srgb_to_linear(double channel) {
+    if (!(channel >= 0.0 && channel <= 1.0)) {
+        return srgb_to_linear_exact(channel);
+    }
+    return interpolate_transfer(transfer_tables().to_linear, channel);
+}
+
+inline double linear_to_srgb(double channel) {
+    if (!(channel >= 0.0 && channel <= 1.0)) {
+        return linear_to_srgb_exact(channel);
+    }
+    return interpolate_transfer(transfer_tables().to_srgb, channel);
+}
+
 // Clamp value to range [0, 1]
 inline double clamp(double value) {
     return std::max(0.0, std::min(1.0, value));
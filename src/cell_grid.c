@@ -0,0 +1,262 @@
+/*
+ * ASCII Image Converter - Terminal Cell Grid
+ *
+ * Copyright (c) 2025 danko12
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "../include/cell_grid.h"
+
+#define RESET "\x1b[0m"
+
+
+void cell_grid_init(cell_grid_t* grid) {
+    memset(grid, 0, sizeof(*grid));
+}
+
+
+// Sets the dimensions, keeping the allocation when it is large enough.
+// Cell contents are unspecified afterwards. Returns 0 on allocation failure.
+int cell_grid_resize(cell_grid_t* grid, size_t width, size_t height) {
+    size_t count = width * height;
+    if (count > grid->width * grid->height || !grid->cells) {
+        cell_t* cells = realloc(grid->cells, (count ? count : 1) * sizeof(*cells));
+        grid->heap_allocations++;
+        if (!cells) {
+            fprintf(stderr, "Error: Failed to allocate cell grid!\n");
+            return 0;
+        }
+        grid->cells = cells;
+    }
+    grid->width = width;
+    grid->height = height;
+    return 1;
+}
+
+
+int cell_grid_copy(cell_grid_t* dst, const cell_grid_t* src) {
+    if (!cell_grid_resize(dst, src->width, src->height)) {
+        return 0;
+    }
+    memcpy(dst->cells, src->cells, src->width * src->height * sizeof(cell_t));
+    return 1;
+}
+
+
+void cell_grid_free(cell_grid_t* grid) {
+    free(grid->cells);
+    grid->width = 0;
+    grid->height = 0;
+    grid->cells = NULL;
+}
+
+
+// ============================================================================
+// Encoders
+// ============================================================================
+
+static size_t decimal_length(size_t value) {
+    size_t length = 1;
+    while (value >= 10) {
+        value /= 10;
+        length++;
+    }
+    return length;
+}
+
+
+static void put_decimal(frame_buffer_t* output, size_t value) {
+    char digits[20];
+    size_t count = 0;
+    do {
+        digits[count++] = (char) ('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (count) {
+        output->data[output->length++] = digits[--count];
+    }
+}
+
+
+// Moves the cursor to 1-based (row, column)
+static void put_cursor_move(frame_buffer_t* output, size_t row, size_t column) {
+    frame_buffer_append(output, "\x1b[", 2);
+    put_decimal(output, row);
+    output->data[output->length++] = ';';
+    put_decimal(output, column);
+    output->data[output->length++] = 'H';
+}
+
+
+static size_t cursor_move_length(size_t row, size_t column) {
+    return 4 + decimal_length(row) + decimal_length(column);
+}
+
+
+static size_t fg_length(const unsigned char rgb[3]) {
+    return 10 + (size_t) byte_decimal[rgb[0]][3] + (size_t) byte_decimal[rgb[1]][3]
+              + (size_t) byte_decimal[rgb[2]][3];
+}
+
+
+// Writes a cell's color sequence and glyph at `out` and returns the end.
+// Encoders write through a local pointer rather than the frame_buffer_t
+// appenders: byte stores may alias the buffer's fields, which would force
+// them to be reloaded after every byte. All GLYPH_MAX_BYTES are copied (the
+// reservations leave room for them) so the copy has a fixed size.
+static inline char* write_fg(char* out, const unsigned char rgb[3]) {
+    memcpy(out, "\x1b[38;2;", 7);
+    out += 7;
+    for (int c = 0; c < 3; c++) {
+        const char* decimal = byte_decimal[rgb[c]];
+        memcpy(out, decimal, 3);
+        out += decimal[3];
+        *out++ = c < 2 ? ';' : 'm';
+    }
+    return out;
+}
+
+static inline char* write_glyph(char* out, const cell_t* cell) {
+    memcpy(out, cell->glyph, GLYPH_MAX_BYTES);
+    return out + cell->length;
+}
+
+
+// Every cell with its own color sequence, rows separated by newlines. The
+// caller positions the cursor first.
+int cell_grid_encode_full(const cell_grid_t* grid, frame_buffer_t* output) {
+    size_t cell_bytes = ANSI_FG_MAX_BYTES + GLYPH_MAX_BYTES;
+    if (!frame_buffer_reserve(output, grid->width * grid->height * cell_bytes + grid->height + sizeof(RESET))) {
+        return 0;
+    }
+
+    char* out = output->data + output->length;
+    for (size_t y = 0; y < grid->height; y++) {
+        const cell_t* row = cell_grid_row(grid, y);
+        for (size_t x = 0; x < grid->width; x++) {
+            out = write_fg(out, row[x].rgb);
+            out = write_glyph(out, &row[x]);
+        }
+        *out++ = '\n';
+    }
+    output->length = (size_t) (out - output->data);
+
+    frame_buffer_append(output, RESET, sizeof(RESET) - 1);
+    return 1;
+}
+
+
+// Foreground color currently set on the terminal, as the encoder tracks it
+typedef struct {
+    unsigned char rgb[3];
+    int valid;
+} pen_t;
+
+
+static void put_cell(frame_buffer_t* output, const cell_t* cell, pen_t* pen) {
+    char* out = output->data + output->length;
+    if (!pen->valid || memcmp(pen->rgb, cell->rgb, 3) != 0) {
+        out = write_fg(out, cell->rgb);
+        memcpy(pen->rgb, cell->rgb, 3);
+        pen->valid = 1;
+    }
+    out = write_glyph(out, cell);
+    output->length = (size_t) (out - output->data);
+}
+
+
+// Bytes needed to re-emit the unchanged cells [from, to), or more than
+// `limit` once that is exceeded
+static size_t bridge_length(const cell_t* row, size_t from, size_t to, pen_t pen, size_t limit) {
+    size_t length = 0;
+    for (size_t x = from; x < to && length <= limit; x++) {
+        if (!pen.valid || memcmp(pen.rgb, row[x].rgb, 3) != 0) {
+            length += fg_length(row[x].rgb);
+            memcpy(pen.rgb, row[x].rgb, 3);
+            pen.valid = 1;
+        }
+        length += row[x].length;
+    }
+    return length;
+}
+
+
+// Only the cells that differ from `previous`, reached with absolute cursor
+// moves. A gap of unchanged cells inside a row is rewritten instead of
+// jumped over when that takes fewer bytes than the cursor move, so nearby
+// changes coalesce into one run. Color sequences are only emitted when the
+// color changes. Ends like a full frame: attributes reset and the cursor
+// below the image. Grids of different sizes fall back to a full redraw.
+int cell_grid_encode_delta(const cell_grid_t* previous, const cell_grid_t* current, frame_buffer_t* output) {
+    size_t width = current->width;
+    size_t height = current->height;
+    if (previous->width != width || previous->height != height) {
+        if (!frame_buffer_reserve(output, 3)) return 0;
+        frame_buffer_append(output, "\x1b[H", 3);
+        return cell_grid_encode_full(current, output);
+    }
+
+    size_t cell_bytes = CURSOR_MOVE_MAX_BYTES + ANSI_FG_MAX_BYTES + GLYPH_MAX_BYTES;
+    if (!frame_buffer_reserve(output, width * height * cell_bytes + sizeof(RESET) + CURSOR_MOVE_MAX_BYTES)) {
+        return 0;
+    }
+
+    pen_t pen = { {0, 0, 0}, 0 };
+    size_t cursor_y = SIZE_MAX;
+    size_t cursor_x = 0;
+
+    for (size_t y = 0; y < height; y++) {
+        const cell_t* before = cell_grid_row(previous, y);
+        const cell_t* row = cell_grid_row(current, y);
+
+        for (size_t x = 0; x < width; x++) {
+            if (cell_equal(&before[x], &row[x])) continue;
+
+            if (cursor_y != y || cursor_x != x) {
+                size_t jump = cursor_move_length(y + 1, x + 1);
+                if (cursor_y == y && cursor_x < x &&
+                    bridge_length(row, cursor_x, x, pen, jump) <= jump) {
+                    for (size_t gap = cursor_x; gap < x; gap++) {
+                        put_cell(output, &row[gap], &pen);
+                    }
+                } else {
+                    put_cursor_move(output, y + 1, x + 1);
+                }
+            }
+
+            put_cell(output, &row[x], &pen);
+            cursor_y = y;
+            cursor_x = x + 1;
+        }
+
+        // After the last column the terminal holds a pending wrap, so the
+        // position is not reliable for a following run
+        if (cursor_y == y && cursor_x == width) {
+            cursor_y = SIZE_MAX;
+        }
+    }
+
+    frame_buffer_append(output, RESET, sizeof(RESET) - 1);
+    put_cursor_move(output, height + 1, 1);
+    return 1;
+}
@@ -0,0 +1,424 @@
+/*
+ * ASCII Image Converter - Convolution Engine
+ *
+ * Copyright (c) 2025 danko12
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../include/convolve.h"
+#include "../include/monotonic_clock.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CONVOLVE_X86 1
+#include <immintrin.h>
+#endif
+
+typedef void (*convolve_f32_fn)(const float*, const float*, const float*, float*, size_t, const float*);
+typedef void (*convolve_q12_fn)(const uint8_t*, const uint8_t*, const uint8_t*, int32_t*, size_t, const int32_t*);
+
+
+// ============================================================================
+// Scalar Kernels
+// ============================================================================
+
+// Taps are summed in kernel order; the SIMD variants keep the same order so
+// float results match bit for bit.
+static void convolve_f32_scalar(const float* above, const float* row, const float* below,
+                                float* out, size_t count, const float* kernel) {
+    for (size_t x = 0; x < count; x++) {
+        out[x] = kernel[0] * above[x] + kernel[1] * above[x + 1] + kernel[2] * above[x + 2]
+               + kernel[3] * row[x]   + kernel[4] * row[x + 1]   + kernel[5] * row[x + 2]
+               + kernel[6] * below[x] + kernel[7] * below[x + 1] + kernel[8] * below[x + 2];
+    }
+}
+
+
+// `kernel` holds 9 coefficients followed by the channel step between taps
+static void convolve_q12_scalar(const uint8_t* above, const uint8_t* row, const uint8_t* below,
+                                int32_t* out, size_t count, const int32_t* kernel) {
+    size_t step = (size_t) kernel[9];
+    for (size_t i = 0; i < count; i++) {
+        out[i] = kernel[0] * above[i] + kernel[1] * above[i + step] + kernel[2] * above[i + 2 * step]
+               + kernel[3] * row[i]   + kernel[4] * row[i + step]   + kernel[5] * row[i + 2 * step]
+               + kernel[6] * below[i] + kernel[7] * below[i + step] + kernel[8] * below[i + 2 * step];
+    }
+}
+
+
+#ifdef CONVOLVE_X86
+// ============================================================================
+// SSE2 (4 lanes)
+// ============================================================================
+
+__attribute__((target("sse2")))
+static void convolve_f32_sse2(const float* above, const float* row, const float* below,
+                              float* out, size_t count, const float* kernel) {
+    __m128 k[9];
+    for (int i = 0; i < 9; i++) k[i] = _mm_set1_ps(kernel[i]);
+
+    size_t x = 0;
+    for (; x + 4 <= count; x += 4) {
+        __m128 acc = _mm_mul_ps(k[0], _mm_loadu_ps(above + x));
+        acc = _mm_add_ps(acc, _mm_mul_ps(k[1], _mm_loadu_ps(above + x + 1)));
+        acc = _mm_add_ps(acc, _mm_mul_ps(k[2], _mm_loadu_ps(above + x + 2)));
+        acc = _mm_add_ps(acc, _mm_mul_ps(k[3], _mm_loadu_ps(row + x)));
+        acc = _mm_add_ps(acc, _mm_mul_ps(k[4], _mm_loadu_ps(row + x + 1)));
+        acc = _mm_add_ps(acc, _mm_mul_ps(k[5], _mm_loadu_ps(row + x + 2)));
+        acc = _mm_add_ps(acc, _mm_mul_ps(k[6], _mm_loadu_ps(below + x)));
+        acc = _mm_add_ps(acc, _mm_mul_ps(k[7], _mm_loadu_ps(below + x + 1)));
+        acc = _mm_add_ps(acc, _mm_mul_ps(k[8], _mm_loadu_ps(below + x + 2)));
+        _mm_storeu_ps(out + x, acc);
+    }
+    convolve_f32_scalar(above + x, row + x, below + x, out + x, count - x, kernel);
+}
+
+
+// SSE2 has no 32-bit multiply, so products are built from the low and high
+// halves of 16-bit multiplies. Requires coefficients that fit in int16.
+__attribute__((target("sse2")))
+static void convolve_q12_sse2(const uint8_t* above, const uint8_t* row, const uint8_t* below,
+                              int32_t* out, size_t count, const int32_t* kernel) {
+    size_t step = (size_t) kernel[9];
+    const uint8_t* taps[9] = {
+        above, above + step, above + 2 * step,
+        row, row + step, row + 2 * step,
+        below, below + step, below + 2 * step
+    };
+    __m128i k[9];
+    for (int i = 0; i < 9; i++) k[i] = _mm_set1_epi16((int16_t) kernel[i]);
+    __m128i zero = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i acc_lo = zero, acc_hi = zero;
+        for (int t = 0; t < 9; t++) {
+            __m128i pixels = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*) (taps[t] + i)), zero);
+            __m128i lo = _mm_mullo_epi16(pixels, k[t]);
+            __m128i hi = _mm_mulhi_epi16(pixels, k[t]);
+            acc_lo = _mm_add_epi32(acc_lo, _mm_unpacklo_epi16(lo, hi));
+            acc_hi = _mm_add_epi32(acc_hi, _mm_unpackhi_epi16(lo, hi));
+        }
+        _mm_storeu_si128((__m128i*) (out + i), acc_lo);
+        _mm_storeu_si128((__m128i*) (out + i + 4), acc_hi);
+    }
+    convolve_q12_scalar(above + i, row + i, below + i, out + i, count - i, kernel);
+}
+
+
+// ============================================================================
+// AVX2 (8 lanes)
+// ============================================================================
+
+__attribute__((target("avx2")))
+static void convolve_f32_avx2(const float* above, const float* row, const float* below,
+                              float* out, size_t count, const float* kernel) {
+    __m256 k[9];
+    for (int i = 0; i < 9; i++) k[i] = _mm256_set1_ps(kernel[i]);
+
+    size_t x = 0;
+    for (; x + 8 <= count; x += 8) {
+        __m256 acc = _mm256_mul_ps(k[0], _mm256_loadu_ps(above + x));
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(k[1], _mm256_loadu_ps(above + x + 1)));
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(k[2], _mm256_loadu_ps(above + x + 2)));
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(k[3], _mm256_loadu_ps(row + x)));
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(k[4], _mm256_loadu_ps(row + x + 1)));
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(k[5], _mm256_loadu_ps(row + x + 2)));
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(k[6], _mm256_loadu_ps(below + x)));
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(k[7], _mm256_loadu_ps(below + x + 1)));
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(k[8], _mm256_loadu_ps(below + x + 2)));
+        _mm256_storeu_ps(out + x, acc);
+    }
+    convolve_f32_scalar(above + x, row + x, below + x, out + x, count - x, kernel);
+}
+
+
+__attribute__((target("avx2")))
+static void convolve_q12_avx2(const uint8_t* above, const uint8_t* row, const uint8_t* below,
+                              int32_t* out, size_t count, const int32_t* kernel) {
+    size_t step = (size_t) kernel[9];
+    const uint8_t* taps[9] = {
+        above, above + step, above + 2 * step,
+        row, row + step, row + 2 * step,
+        below, below + step, below + 2 * step
+    };
+    __m256i k[9];
+    for (int i = 0; i < 9; i++) k[i] = _mm256_set1_epi32(kernel[i]);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i acc = _mm256_setzero_si256();
+        for (int t = 0; t < 9; t++) {
+            __m256i pixels = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*) (taps[t] + i)));
+            acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(pixels, k[t]));
+        }
+        _mm256_storeu_si256((__m256i*) (out + i), acc);
+    }
+    convolve_q12_scalar(above + i, row + i, below + i, out + i, count - i, kernel);
+}
+
+
+// ============================================================================
+// AVX-512 (16 lanes)
+// ============================================================================
+
+// AVX-512F lets the compiler fuse mul+add into FMA, which rounds once and
+// would no longer match the scalar kernel; the explicit-rounding forms are
+// never contracted.
+#define MUL512(a, b) _mm512_mul_round_ps((a), (b), _MM_FROUND_CUR_DIRECTION)
+#define ADD512(a, b) _mm512_add_round_ps((a), (b), _MM_FROUND_CUR_DIRECTION)
+
+__attribute__((target("avx512f")))
+static void convolve_f32_avx512(const float* above, const float* row, const float* below,
+                                float* out, size_t count, const float* kernel) {
+    __m512 k[9];
+    for (int i = 0; i < 9; i++) k[i] = _mm512_set1_ps(kernel[i]);
+
+    size_t x = 0;
+    for (; x + 16 <= count; x += 16) {
+        __m512 acc = MUL512(k[0], _mm512_loadu_ps(above + x));
+        acc = ADD512(acc, MUL512(k[1], _mm512_loadu_ps(above + x + 1)));
+        acc = ADD512(acc, MUL512(k[2], _mm512_loadu_ps(above + x + 2)));
+        acc = ADD512(acc, MUL512(k[3], _mm512_loadu_ps(row + x)));
+        acc = ADD512(acc, MUL512(k[4], _mm512_loadu_ps(row + x + 1)));
+        acc = ADD512(acc, MUL512(k[5], _mm512_loadu_ps(row + x + 2)));
+        acc = ADD512(acc, MUL512(k[6], _mm512_loadu_ps(below + x)));
+        acc = ADD512(acc, MUL512(k[7], _mm512_loadu_ps(below + x + 1)));
+        acc = ADD512(acc, MUL512(k[8], _mm512_loadu_ps(below + x + 2)));
+        _mm512_storeu_ps(out + x, acc);
+    }
+    convolve_f32_scalar(above + x, row + x, below + x, out + x, count - x, kernel);
+}
+
+
+__attribute__((target("avx512f")))
+static void convolve_q12_avx512(const uint8_t* above, const uint8_t* row, const uint8_t* below,
+                                int32_t* out, size_t count, const int32_t* kernel) {
+    size_t step = (size_t) kernel[9];
+    const uint8_t* taps[9] = {
+        above, above + step, above + 2 * step,
+        row, row + step, row + 2 * step,
+        below, below + step, below + 2 * step
+    };
+    __m512i k[9];
+    for (int i = 0; i < 9; i++) k[i] = _mm512_set1_epi32(kernel[i]);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512i acc = _mm512_setzero_si512();
+        for (int t = 0; t < 9; t++) {
+            __m512i pixels = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i*) (taps[t] + i)));
+            acc = _mm512_add_epi32(acc, _mm512_mullo_epi32(pixels, k[t]));
+        }
+        _mm512_storeu_si512((void*) (out + i), acc);
+    }
+    convolve_q12_scalar(above + i, row + i, below + i, out + i, count - i, kernel);
+}
+#endif
+
+
+// ============================================================================
+// Runtime Dispatch
+// ============================================================================
+
+static const convolve_f32_fn f32_variants[CONVOLVE_VARIANT_COUNT] = {
+    convolve_f32_scalar,
+#ifdef CONVOLVE_X86
+    convolve_f32_sse2, convolve_f32_avx2, convolve_f32_avx512
+#endif
+};
+
+static const convolve_q12_fn q12_variants[CONVOLVE_VARIANT_COUNT] = {
+    convolve_q12_scalar,
+#ifdef CONVOLVE_X86
+    convolve_q12_sse2, convolve_q12_avx2, convolve_q12_avx512
+#endif
+};
+
+static int active_variant = -1;
+
+
+int convolve_variant_supported(convolve_variant_t variant) {
+    switch (variant) {
+        case CONVOLVE_SCALAR:
+            return 1;
+#ifdef CONVOLVE_X86
+        case CONVOLVE_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case CONVOLVE_AVX2:
+            return __builtin_cpu_supports("avx2");
+        case CONVOLVE_AVX512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return 0;
+    }
+}
+
+
+// Widest variant the CPU supports, chosen on first use
+convolve_variant_t convolve_active_variant(void) {
+    if (active_variant < 0) {
+#ifdef CONVOLVE_X86
+        __builtin_cpu_init();
+#endif
+        active_variant = CONVOLVE_SCALAR;
+        for (int v = CONVOLVE_VARIANT_COUNT - 1; v > CONVOLVE_SCALAR; v--) {
+            if (convolve_variant_supported((convolve_variant_t) v)) {
+                active_variant = v;
+                break;
+            }
+        }
+    }
+    return (convolve_variant_t) active_variant;
+}
+
+
+// Forces a variant (e.g. for benchmarking). Unsupported variants are ignored.
+void convolve_select_variant(convolve_variant_t variant) {
+    if (variant < CONVOLVE_VARIANT_COUNT && convolve_variant_supported(variant)) {
+        active_variant = variant;
+    }
+}
+
+
+const char* convolve_variant_name(convolve_variant_t variant) {
+    static const char* names[CONVOLVE_VARIANT_COUNT] = {"scalar", "sse2", "avx2", "avx512"};
+    return variant < CONVOLVE_VARIANT_COUNT ? names[variant] : "unknown";
+}
+
+
+void convolve_row_f32(const float* above, const float* row, const float* below,
+                      float* out, size_t width, const float kernel[9]) {
+    if (width < 3) return;
+    f32_variants[convolve_active_variant()](above, row, below, out + 1, width - 2, kernel);
+}
+
+
+void convolve_row_q12(const uint8_t* above, const uint8_t* row, const uint8_t* below,
+                      int32_t* out, size_t width, size_t channels, const int32_t kernel[9]) {
+    if (width < 3) return;
+
+    int32_t taps[10];
+    memcpy(taps, kernel, 9 * sizeof(*taps));
+    taps[9] = (int32_t) channels;
+
+    convolve_variant_t variant = convolve_active_variant();
+    if (variant == CONVOLVE_SSE2) {
+        // The 16-bit multiplies need coefficients that fit in int16
+        for (int i = 0; i < 9; i++) {
+            if (kernel[i] < INT16_MIN || kernel[i] > INT16_MAX) {
+                variant = CONVOLVE_SCALAR;
+                break;
+            }
+        }
+    }
+    q12_variants[variant](above, row, below, out + channels, (width - 2) * channels, taps);
+}
+
+
+// ============================================================================
+// Benchmark (--bench)
+// ============================================================================
+
+// Runs Sobel Gx over a float luminance plane and the 1-2-1 blur over the
+// interleaved 8-bit pixels with every supported variant, reporting
+// throughput and whether each variant matches the scalar output.
+void convolve_run_bench(const image_t* image, int runs) {
+    size_t width = image->width, height = image->height, channels = image->channels;
+    size_t row_length = width * channels;
+    if (width < 3 || height < 3) {
+        fprintf(stderr, "Error: Image too small to benchmark!\n");
+        return;
+    }
+
+    uint8_t* bytes = malloc(row_length * height);
+    float* plane = malloc(width * height * sizeof(*plane));
+    float* f32_out = calloc(width * height * 2, sizeof(*f32_out));
+    int32_t* q12_out = calloc(row_length * height * 2, sizeof(*q12_out));
+    if (!bytes || !plane || !f32_out || !q12_out) {
+        fprintf(stderr, "Error: Failed to allocate benchmark buffers!\n");
+        free(bytes); free(plane); free(f32_out); free(q12_out);
+        return;
+    }
+    float* f32_reference = f32_out + width * height;
+    int32_t* q12_reference = q12_out + row_length * height;
+
+    for (size_t i = 0; i < row_length * height; i++) {
+        bytes[i] = (uint8_t) (PIXEL_TO_UNIT(image->data[i]) * 255.0 + 0.5);
+    }
+    for (size_t i = 0; i < width * height; i++) {
+        plane[i] = (float) PIXEL_TO_UNIT(image->data[i * channels]);
+    }
+
+    static const float sobel_x[9] = {-1.f, 0.f, 1.f, -2.f, 0.f, 2.f, -1.f, 0.f, 1.f};
+    static const int32_t blur[9] = {256, 512, 256, 512, 1024, 512, 256, 512, 256};
+
+    convolve_variant_t selected = convolve_active_variant();
+    printf("Convolution bench: %zux%zu, %zu channels, best of %d runs (active: %s)\n",
+           width, height, channels, runs, convolve_variant_name(selected));
+    printf("  %-8s %16s %18s  %s\n", "variant", "f32 Sobel Mpx/s", "q12 blur Msamp/s", "matches scalar");
+
+    for (int v = 0; v < CONVOLVE_VARIANT_COUNT; v++) {
+        if (!convolve_variant_supported((convolve_variant_t) v)) {
+            printf("  %-8s %16s %18s\n", convolve_variant_name((convolve_variant_t) v), "-", "-");
+            continue;
+        }
+        convolve_select_variant((convolve_variant_t) v);
+
+        double f32_best = 1e30, q12_best = 1e30;
+        for (int run = 0; run < runs; run++) {
+            double start = seconds_now();
+            for (size_t y = 1; y + 1 < height; y++) {
+                convolve_row_f32(plane + (y - 1) * width, plane + y * width, plane + (y + 1) * width,
+                                 f32_out + y * width, width, sobel_x);
+            }
+            double middle = seconds_now();
+            for (size_t y = 1; y + 1 < height; y++) {
+                convolve_row_q12(bytes + (y - 1) * row_length, bytes + y * row_length, bytes + (y + 1) * row_length,
+                                 q12_out + y * row_length, width, channels, blur);
+            }
+            double end = seconds_now();
+            if (middle - start < f32_best) f32_best = middle - start;
+            if (end - middle < q12_best) q12_best = end - middle;
+        }
+
+        if (v == CONVOLVE_SCALAR) {
+            memcpy(f32_reference, f32_out, width * height * sizeof(*f32_out));
+            memcpy(q12_reference, q12_out, row_length * height * sizeof(*q12_out));
+        }
+        int matches = !memcmp(f32_reference, f32_out, width * height * sizeof(*f32_out))
+                   && !memcmp(q12_reference, q12_out, row_length * height * sizeof(*q12_out));
+
+        printf("  %-8s %16.1f %18.1f  %s\n", convolve_variant_name((convolve_variant_t) v),
+               (double) (width - 2) * (height - 2) / f32_best / 1e6,
+               (double) (width - 2) * channels * (height - 2) / q12_best / 1e6,
+               matches ? "yes" : "NO");
+    }
+
+    convolve_select_variant(selected);
+    free(bytes);
+    free(plane);
+    free(f32_out);
+    free(q12_out);
+}
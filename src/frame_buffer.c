@@ -0,0 +1,125 @@
+/*
+ * ASCII Image Converter - Frame Output Buffer
+ *
+ * Copyright (c) 2025 danko12
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "../include/frame_buffer.h"
+
+char byte_decimal[256][4];
+
+
+static void init_byte_decimal(void) {
+    if (byte_decimal[255][3]) return;
+
+    for (int value = 0; value < 256; value++) {
+        char* decimal = byte_decimal[value];
+        int length = snprintf(decimal, 4, "%d", value);
+        decimal[3] = (char) length;
+    }
+}
+
+
+void frame_buffer_init(frame_buffer_t* buffer) {
+    memset(buffer, 0, sizeof(*buffer));
+    init_byte_decimal();
+}
+
+
+// Makes room for `bytes` more bytes. Returns 0 on allocation failure.
+int frame_buffer_reserve(frame_buffer_t* buffer, size_t bytes) {
+    if (buffer->length + bytes <= buffer->capacity) {
+        return 1;
+    }
+
+    size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+    while (capacity < buffer->length + bytes) {
+        capacity *= 2;
+    }
+
+    char* data = realloc(buffer->data, capacity);
+    buffer->heap_allocations++;
+    if (!data) {
+        fprintf(stderr, "Error: Failed to allocate output buffer!\n");
+        return 0;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return 1;
+}
+
+
+// Writes already encoded bytes to fd. Returns 0 on write error.
+int frame_buffer_write(int fd, const char* data, size_t length) {
+    // Anything still in stdio must reach the terminal first
+    fflush(stdout);
+
+    size_t written = 0;
+    while (written < length) {
+        ssize_t result = write(fd, data + written, length - written);
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        written += (size_t) result;
+    }
+    return 1;
+}
+
+
+// Writes the whole buffer to fd and empties it. Returns 0 on write error.
+int frame_buffer_flush(frame_buffer_t* buffer, int fd) {
+    int result = frame_buffer_write(fd, buffer->data, buffer->length);
+    buffer->length = 0;
+    return result;
+}
+
+
+// Releases the capacity beyond the current length
+void frame_buffer_shrink(frame_buffer_t* buffer) {
+    if (buffer->length == buffer->capacity) return;
+
+    if (buffer->length == 0) {
+        free(buffer->data);
+        buffer->data = NULL;
+        buffer->capacity = 0;
+        return;
+    }
+
+    char* data = realloc(buffer->data, buffer->length);
+    buffer->heap_allocations++;
+    if (data) {
+        buffer->data = data;
+        buffer->capacity = buffer->length;
+    }
+}
+
+
+void frame_buffer_free(frame_buffer_t* buffer) {
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+}
@@ -0,0 +1,750 @@
+/*
+ * ASCII Image Converter - Frame Pipeline
+ *
+ * Copyright (c) 2025 danko12
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "../include/frame_pipeline.h"
+#include "../include/convolve.h"
+#include "../include/content_hash.h"
+#include "../include/monotonic_clock.h"
+
+
+// Builds the frames one loop shows: the --frames range, clamped to the
+// animation, forwards, backwards or forwards then back. Ping-pong does not
+// repeat either end, so it loops without holding a frame twice. Returns 0 if
+// out of memory or the range starts past the last frame.
+int playback_order_init(playback_order_t* order, const args_t* args, int frame_count) {
+    order->frames = NULL;
+    order->length = 0;
+    int first = args->frame_first > 0 ? args->frame_first - 1 : 0;
+    int last = args->frame_last > 0 && args->frame_last < frame_count ? args->frame_last - 1 : frame_count - 1;
+    if (first > last) {
+        fprintf(stderr, "Error: Frame range starts after the last frame (%d)\n", frame_count);
+        return 0;
+    }
+
+    int span = last - first + 1;
+    int length = args->playback == PLAYBACK_PING_PONG && span > 2 ? 2 * span - 2 : span;
+    order->frames = malloc((size_t) length * sizeof(*order->frames));
+    if (!order->frames) {
+        fprintf(stderr, "Error: Failed to allocate playback order!\n");
+        return 0;
+    }
+    for (int i = 0; i < length; i++) {
+        int step = i < span ? i : 2 * span - 2 - i;
+        order->frames[i] = args->playback == PLAYBACK_REVERSE ? last - step : first + step;
+    }
+    order->length = length;
+    return 1;
+}
+
+
+void playback_order_free(playback_order_t* order) {
+    free(order->frames);
+    order->frames = NULL;
+    order->length = 0;
+}
+
+
+// One worker per online core, at most FRAME_PIPELINE_MAX_WORKERS
+int frame_pipeline_default_workers(void) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores < 1) return 1;
+    return cores < FRAME_PIPELINE_MAX_WORKERS ? (int) cores : FRAME_PIPELINE_MAX_WORKERS;
+}
+
+
+// Copies the composed frame into the worker's own buffer, so the source can
+// move on to the next frame while this one is resized
+static const image_t* copy_canvas(pipeline_worker_t* worker, const image_t* composed) {
+    image_t* canvas = &worker->canvas;
+    size_t samples = composed->width * composed->height * composed->channels;
+    if (canvas->width * canvas->height * canvas->channels != samples) {
+        free_image(canvas);
+        canvas->data = malloc(samples * sizeof(*canvas->data));
+        worker->heap_allocations++;
+        if (!canvas->data) {
+            fprintf(stderr, "Error: Failed to allocate frame copy!\n");
+            *canvas = (image_t) {0};
+            return NULL;
+        }
+    }
+    memcpy(canvas->data, composed->data, samples * sizeof(*canvas->data));
+    canvas->width = composed->width;
+    canvas->height = composed->height;
+    canvas->channels = composed->channels;
+    return canvas;
+}
+
+
+// Output cells [*first, *last) whose source spans overlap [start, end)
+static void cover_spans(size_t start, size_t end, size_t out_size, size_t in_size, size_t* first, size_t* last) {
+    *first = *last = 0;
+    for (size_t i = 0; i < out_size; i++) {
+        size_t span_start, span_end;
+        get_resize_span(i, out_size, in_size, &span_start, &span_end);
+        if (span_start < end && span_end > start) {
+            if (*last == 0) *first = i;
+            *last = i + 1;
+        }
+    }
+}
+
+
+static size_t grow_down(size_t value, size_t amount) {
+    return value > amount ? value - amount : 0;
+}
+
+
+static size_t grow_up(size_t value, size_t amount, size_t limit) {
+    return value + amount < limit ? value + amount : limit;
+}
+
+
+static size_t source_allocations(const gif_source_t* source) {
+    return source->heap_allocations + source->decoder.heap_allocations;
+}
+
+
+static size_t worker_allocations(const pipeline_worker_t* worker) {
+    return worker->heap_allocations + worker->scratch.heap_allocations;
+}
+
+
+// Grows the slot's buffer to hold `samples`. Once it has reached the largest
+// frame, preparing frames into the slot allocates nothing.
+static int reserve_slot(pipeline_worker_t* worker, prepared_frame_t* slot, size_t samples) {
+    if (samples == 0) samples = 1;
+    if (samples <= slot->capacity) return 1;
+    pixel_t* buffer = realloc(slot->buffer, samples * sizeof(*buffer));
+    worker->heap_allocations++;
+    if (!buffer) {
+        fprintf(stderr, "Error: Failed to allocate prepared frame!\n");
+        return 0;
+    }
+    slot->buffer = buffer;
+    slot->capacity = samples;
+    return 1;
+}
+
+
+// Resizes and sharpens a composed frame into `slot`. With `changes`, the
+// canvas region that differs from the previous frame, only the cells that
+// region reaches are prepared: the cells whose source spans it overlaps,
+// widened by the reach of the sharpening filter. Sharpening needs that
+// reach again around them as input, so a larger block is resized and
+// sharpened and its middle kept. Both steps are exact on a crop, so the
+// patch matches the same cells of a whole prepared frame.
+static void prepare_frame(pipeline_worker_t* worker, prepared_frame_t* slot, const image_t* composed,
+                          const gif_frame_info_t* changes) {
+    const args_t* args = worker->pipeline->args;
+    slot->image = (image_t) {0};
+    slot->left = slot->top = 0;
+    slot->partial = 0;
+    slot->kept = 0;
+    if (!composed) return;
+
+    size_t width, height;
+    get_resized_dimensions(composed->width, composed->height, args->max_width, args->max_height,
+                           args->character_ratio, &width, &height);
+
+    size_t left = 0, top = 0, right = width, bottom = height;
+    if (changes) {
+        cover_spans((size_t) changes->changed_left, (size_t) changes->changed_right, width, composed->width,
+                    &left, &right);
+        cover_spans((size_t) changes->changed_top, (size_t) changes->changed_bottom, height, composed->height,
+                    &top, &bottom);
+        if (right <= left || bottom <= top) {
+            // Identical to the frame before
+            slot->partial = 1;
+            return;
+        }
+    }
+
+    int sharpen = args->sharpen_strength > 0.0;
+    size_t halo = sharpen ? unsharp_mask_halo(args->sharpen_radius) : 0;
+    left = grow_down(left, halo);
+    top = grow_down(top, halo);
+    right = grow_up(right, halo, width);
+    bottom = grow_up(bottom, halo, height);
+    slot->partial = left > 0 || top > 0 || right < width || bottom < height;
+
+    size_t crop_left = grow_down(left, halo), crop_top = grow_down(top, halo);
+    size_t crop_right = grow_up(right, halo, width), crop_bottom = grow_up(bottom, halo, height);
+    image_t image = {
+        .width = crop_right - crop_left,
+        .height = crop_bottom - crop_top,
+        .channels = composed->channels
+    };
+    if (reserve_slot(worker, slot, image.width * image.height * image.channels) &&
+        resize_region_into(composed, width, height, crop_left, crop_top, crop_right, crop_bottom,
+                           slot->buffer, &worker->scratch)) {
+        image.data = slot->buffer;
+    }
+
+    // Apply sharpening on resized frame (not original!)
+    if (image.data && sharpen) {
+        unsharp_mask(&image, args->sharpen_strength, args->sharpen_radius, &worker->scratch);
+    }
+    arena_reset(&worker->scratch);
+
+    // Keep the middle of the block: rows move towards the start, never overlapping ahead
+    if (image.data && (crop_left != left || crop_top != top || crop_right != right || crop_bottom != bottom)) {
+        size_t row_length = (right - left) * image.channels;
+        for (size_t y = 0; y < bottom - top; y++) {
+            memmove(image.data + y * row_length,
+                    get_pixel(&image, left - crop_left, top - crop_top + y),
+                    row_length * sizeof(*image.data));
+        }
+        image.width = right - left;
+        image.height = bottom - top;
+    }
+
+    slot->image = image;
+    slot->left = left;
+    slot->top = top;
+}
+
+
+// Frame shown at playback position `position`
+static int frame_at(const frame_pipeline_t* pipeline, long position) {
+    long i = position % pipeline->loop_length;
+    return pipeline->order ? pipeline->order[i] : (int) i;
+}
+
+
+// The changed region of the frame at `position` is relative to the frame
+// composed before it, so it only applies when that was the frame shown
+// before. A frame whose canvas hashes the same as the one shown before is a
+// repeat in any order, and `info`, the frame's copy, is emptied to say so.
+static const gif_frame_info_t* changes_at(const frame_pipeline_t* pipeline, long position,
+                                          gif_frame_info_t* info) {
+    if (position <= pipeline->first) return NULL;
+    int frame = frame_at(pipeline, position);
+    int previous = frame_at(pipeline, position - 1);
+    if (info->hash && info->hash == pipeline->source->decoder.frames[previous].hash) {
+        info->changed_left = info->changed_top = info->changed_right = info->changed_bottom = 0;
+        return info;
+    }
+    return frame == previous + 1 || (frame == 0 && previous == pipeline->frame_count - 1) ? info : NULL;
+}
+
+
+// The kept canvas that prepares a frame with content `hash`, or NULL. A
+// repeat of the frame before, `changes` empty, is cheaper as an empty patch.
+static const image_t* find_kept(frame_pipeline_t* pipeline, uint64_t hash, const gif_frame_info_t* changes) {
+    if (!hash || (changes && changes->changed_right <= changes->changed_left)) return NULL;
+    const image_t* kept = NULL;
+    pthread_mutex_lock(&pipeline->lock);
+    for (int i = 0; i < pipeline->kept_count && !kept; i++) {
+        if (pipeline->kept[i].hash == hash) kept = &pipeline->kept[i].image;
+    }
+    pthread_mutex_unlock(&pipeline->lock);
+    return kept;
+}
+
+
+static void reuse_kept(prepared_frame_t* slot, const image_t* kept) {
+    slot->image = *kept;
+    slot->left = slot->top = 0;
+    slot->partial = 0;
+    slot->kept = 1;
+}
+
+
+// Workers run ahead only once the first frame is taken, so on a busy or
+// single-core machine they do not delay that frame
+static int has_room(const frame_pipeline_t* pipeline) {
+    return pipeline->claimed - pipeline->consumed < pipeline->depth &&
+           (pipeline->limit < 0 || pipeline->claimed < pipeline->limit) &&
+           (pipeline->claimed == pipeline->first || pipeline->consumed > pipeline->first);
+}
+
+
+static void* pipeline_worker(void* arg) {
+    pipeline_worker_t* worker = arg;
+    frame_pipeline_t* pipeline = worker->pipeline;
+
+    pthread_mutex_lock(&pipeline->lock);
+    for (;;) {
+        while (!pipeline->stop && !has_room(pipeline)) {
+            pthread_cond_wait(&pipeline->changed, &pipeline->lock);
+        }
+        if (pipeline->stop) break;
+
+        // The slot is free: the player has released everything before it
+        long sequence = pipeline->claimed++;
+        prepared_frame_t* slot = &pipeline->slots[sequence % pipeline->depth];
+        slot->frame = frame_at(pipeline, sequence);
+
+        // Decode the frame's LZW data while earlier frames are composed,
+        // unless it is the source's turn already or the window holds it
+        const gif_raster_t* decoded = NULL;
+        if (worker->raster.indices && pipeline->decoded != sequence) {
+            pthread_mutex_unlock(&pipeline->lock);
+            if (!gif_source_holds(pipeline->source, slot->frame)) {
+                gif_raster_decode(&worker->raster, &pipeline->source->decoder, slot->frame);
+                decoded = &worker->raster;
+            }
+            pthread_mutex_lock(&pipeline->lock);
+        }
+
+        // Frames are composed in order: wait for this one's turn at the source
+        while (!pipeline->stop && pipeline->decoded != sequence) {
+            pthread_cond_wait(&pipeline->changed, &pipeline->lock);
+        }
+        if (pipeline->stop) break;
+        pthread_mutex_unlock(&pipeline->lock);
+
+        // The source's counts only move at its turn, so read them before passing it on
+        size_t source_before = source_allocations(pipeline->source);
+        size_t worker_before = worker_allocations(worker);
+        const image_t* composed = gif_source_frame(pipeline->source, slot->frame, decoded);
+        gif_frame_info_t changes = composed ? pipeline->source->decoder.frames[slot->frame] : (gif_frame_info_t) {0};
+        const gif_frame_info_t* changed = changes_at(pipeline, sequence, &changes);
+        size_t from_source = source_allocations(pipeline->source) - source_before;
+        slot->playable_frames = pipeline->source->decoder.playable_frames;
+        slot->hash = changes.hash;
+        const image_t* kept = find_kept(pipeline, changes.hash, changed);
+        if (kept) {
+            reuse_kept(slot, kept);
+            pthread_mutex_lock(&pipeline->lock);
+            pipeline->decoded++;
+        } else if (pipeline->worker_slots > 1 && composed) {
+            composed = copy_canvas(worker, composed);
+            pthread_mutex_lock(&pipeline->lock);
+            pipeline->decoded++;
+            pthread_cond_broadcast(&pipeline->changed);
+            pthread_mutex_unlock(&pipeline->lock);
+            prepare_frame(worker, slot, composed, changed);
+            pthread_mutex_lock(&pipeline->lock);
+        } else {
+            // A single worker resizes straight from the source's canvas
+            prepare_frame(worker, slot, composed, changed);
+            pthread_mutex_lock(&pipeline->lock);
+            pipeline->decoded++;
+        }
+        slot->heap_allocations = from_source + worker_allocations(worker) - worker_before;
+        slot->ready = 1;
+        pthread_cond_broadcast(&pipeline->changed);
+    }
+    pthread_mutex_unlock(&pipeline->lock);
+    return NULL;
+}
+
+
+// Starts preparing frames of `source` in playback `order` (NULL for every
+// frame in order) on `workers` threads (0 for one per core), from position
+// `first` up to `limit` (-1 for no limit). Positions count frames across
+// loops. Returns 0 if out of memory.
+int frame_pipeline_start(frame_pipeline_t* pipeline, gif_source_t* source, const args_t* args,
+                          const playback_order_t* order, int workers, long first, long limit) {
+    memset(pipeline, 0, sizeof(*pipeline));
+    pipeline->source = source;
+    pipeline->args = args;
+    pipeline->frame_count = source->decoder.playable_frames;
+    pipeline->order = order ? order->frames : NULL;
+    pipeline->loop_length = order ? order->length : pipeline->frame_count;
+    pipeline->first = first;
+    pipeline->claimed = first;
+    pipeline->decoded = first;
+    pipeline->consumed = first;
+    pipeline->limit = limit;
+    pthread_mutex_init(&pipeline->lock, NULL);
+    pthread_cond_init(&pipeline->changed, NULL);
+
+    if (workers <= 0) workers = frame_pipeline_default_workers();
+    if (workers > pipeline->loop_length) workers = pipeline->loop_length;
+    pipeline->depth = workers + FRAME_PIPELINE_AHEAD;
+    pipeline->slots = calloc(pipeline->depth, sizeof(*pipeline->slots));
+    pipeline->workers = calloc(workers, sizeof(*pipeline->workers));
+    if (!pipeline->slots || !pipeline->workers) {
+        fprintf(stderr, "Error: Failed to allocate frame pipeline!\n");
+        free(pipeline->slots);
+        free(pipeline->workers);
+        pthread_mutex_destroy(&pipeline->lock);
+        pthread_cond_destroy(&pipeline->changed);
+        pipeline->source = NULL;
+        return 0;
+    }
+    pipeline->worker_slots = workers;
+    pipeline->heap_allocations = 2;
+    for (int i = 0; i < workers; i++) {
+        pipeline->workers[i].pipeline = pipeline;
+        pipeline->workers[i].raster.frame = -1;
+        arena_init(&pipeline->workers[i].scratch);
+        // A single worker has nothing to overlap decoding with. Without a
+        // raster, a worker decodes at its turn instead.
+        if (workers > 1) {
+            gif_raster_init(&pipeline->workers[i].raster, &source->decoder);
+            pipeline->heap_allocations += 2;
+        }
+    }
+
+    // Settle the lazily chosen convolution variant before threads use it
+    convolve_active_variant();
+
+    // Workers block all signals so SIGINT and SIGWINCH reach the player
+    sigset_t all, previous;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &previous);
+    for (int i = 0; i < workers; i++) {
+        if (pthread_create(&pipeline->workers[i].thread, NULL, pipeline_worker, &pipeline->workers[i]) != 0) {
+            break;
+        }
+        pipeline->worker_count++;
+    }
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+
+    if (pipeline->worker_count == 0) {
+        fprintf(stderr, "Warning: Could not start frame workers, preparing frames on demand\n");
+    }
+    return 1;
+}
+
+
+// Waits for the next frame in playback order. It stays valid until
+// frame_pipeline_release(); callers must not ask past the limit.
+const prepared_frame_t* frame_pipeline_next(frame_pipeline_t* pipeline) {
+    prepared_frame_t* slot = &pipeline->slots[pipeline->consumed % pipeline->depth];
+    if (pipeline->worker_count == 0) {
+        pipeline_worker_t* worker = &pipeline->workers[0];
+        size_t before = source_allocations(pipeline->source) + worker_allocations(worker);
+        slot->frame = frame_at(pipeline, pipeline->consumed);
+        const image_t* composed = gif_source_frame(pipeline->source, slot->frame, NULL);
+        gif_frame_info_t changes = composed ? pipeline->source->decoder.frames[slot->frame] : (gif_frame_info_t) {0};
+        const gif_frame_info_t* changed = changes_at(pipeline, pipeline->consumed, &changes);
+        const image_t* kept = find_kept(pipeline, changes.hash, changed);
+        if (kept) {
+            reuse_kept(slot, kept);
+        } else {
+            prepare_frame(worker, slot, composed, changed);
+        }
+        slot->playable_frames = pipeline->source->decoder.playable_frames;
+        slot->hash = changes.hash;
+        slot->heap_allocations = source_allocations(pipeline->source) + worker_allocations(worker) - before;
+        slot->ready = 1;
+        return slot;
+    }
+
+    pthread_mutex_lock(&pipeline->lock);
+    while (!slot->ready) {
+        pthread_cond_wait(&pipeline->changed, &pipeline->lock);
+    }
+    pthread_mutex_unlock(&pipeline->lock);
+    return slot;
+}
+
+
+// Returns the frame from frame_pipeline_next() to its slot and makes room
+// for another
+void frame_pipeline_release(frame_pipeline_t* pipeline) {
+    prepared_frame_t* slot = &pipeline->slots[pipeline->consumed % pipeline->depth];
+    slot->image = (image_t) {0};
+    pipeline->heap_allocations += slot->heap_allocations;
+
+    pthread_mutex_lock(&pipeline->lock);
+    slot->ready = 0;
+    pipeline->consumed++;
+    pthread_cond_broadcast(&pipeline->changed);
+    pthread_mutex_unlock(&pipeline->lock);
+}
+
+
+// Keeps `image`, the whole frame prepared from a canvas with content `hash`,
+// for workers to hand out instead of preparing that canvas again. Only the
+// player calls it; the first FRAME_PIPELINE_KEPT distinct canvases are kept.
+void frame_pipeline_keep(frame_pipeline_t* pipeline, uint64_t hash, const image_t* image) {
+    if (!hash || !image->data || pipeline->kept_count == FRAME_PIPELINE_KEPT) return;
+    for (int i = 0; i < pipeline->kept_count; i++) {
+        if (pipeline->kept[i].hash == hash) return;
+    }
+
+    kept_canvas_t* kept = &pipeline->kept[pipeline->kept_count];
+    size_t samples = image->width * image->height * image->channels;
+    kept->image = *image;
+    kept->image.data = malloc(samples * sizeof(*image->data));
+    pipeline->heap_allocations++;
+    if (!kept->image.data) return;
+    memcpy(kept->image.data, image->data, samples * sizeof(*image->data));
+    kept->hash = hash;
+
+    pthread_mutex_lock(&pipeline->lock);
+    pipeline->kept_count++;
+    pthread_mutex_unlock(&pipeline->lock);
+}
+
+
+// Raises the number of frames to prepare (-1 for no limit)
+void frame_pipeline_extend(frame_pipeline_t* pipeline, long limit) {
+    pthread_mutex_lock(&pipeline->lock);
+    pipeline->limit = limit;
+    pthread_cond_broadcast(&pipeline->changed);
+    pthread_mutex_unlock(&pipeline->lock);
+}
+
+
+// Stops the workers and frees any frames prepared but not taken. Safe to
+// call again once stopped.
+void frame_pipeline_stop(frame_pipeline_t* pipeline) {
+    if (!pipeline->source) return;
+
+    pthread_mutex_lock(&pipeline->lock);
+    pipeline->stop = 1;
+    pthread_cond_broadcast(&pipeline->changed);
+    pthread_mutex_unlock(&pipeline->lock);
+    for (int i = 0; i < pipeline->worker_count; i++) {
+        pthread_join(pipeline->workers[i].thread, NULL);
+    }
+
+    for (int i = 0; i < pipeline->depth; i++) {
+        free(pipeline->slots[i].buffer);
+    }
+    for (int i = 0; i < pipeline->kept_count; i++) {
+        free_image(&pipeline->kept[i].image);
+    }
+    for (int i = 0; i < pipeline->worker_slots; i++) {
+        arena_free(&pipeline->workers[i].scratch);
+        free_image(&pipeline->workers[i].canvas);
+        gif_raster_free(&pipeline->workers[i].raster);
+    }
+    free(pipeline->slots);
+    free(pipeline->workers);
+    pthread_mutex_destroy(&pipeline->lock);
+    pthread_cond_destroy(&pipeline->changed);
+    pipeline->source = NULL;
+}
+
+
+// ============================================================================
+// Benchmark (--bench --animate)
+// ============================================================================
+
+// Folds a prepared frame's size and pixels into a running checksum
+static uint64_t hash_frame(uint64_t hash, const image_t* image) {
+    size_t header[3] = { image->width, image->height, image->channels };
+    size_t length = image->data ? image->width * image->height * image->channels * sizeof(*image->data) : 0;
+    hash = hash * 31 + content_hash(header, sizeof(header));
+    return hash * 31 + content_hash(image->data, length);
+}
+
+
+// Two-phase decode: threads decode rasters ahead in frame order while the
+// calling thread composes them in order
+typedef struct {
+    const gif_decoder_t* decoder;
+    gif_raster_t* rasters;      // ring: frame i decodes into rasters[i % depth]
+    int* ready;
+    int depth;
+    int frame_count;
+    int next;                   // next frame to decode
+    int composed;               // frames composed so far
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} decode_bench_t;
+
+
+static void* decode_bench_worker(void* arg) {
+    decode_bench_t* bench = arg;
+
+    pthread_mutex_lock(&bench->lock);
+    for (;;) {
+        while (bench->next < bench->frame_count && bench->next - bench->composed >= bench->depth) {
+            pthread_cond_wait(&bench->changed, &bench->lock);
+        }
+        if (bench->next >= bench->frame_count) break;
+        int frame = bench->next++;
+        pthread_mutex_unlock(&bench->lock);
+
+        gif_raster_decode(&bench->rasters[frame % bench->depth], bench->decoder, frame);
+
+        pthread_mutex_lock(&bench->lock);
+        bench->ready[frame % bench->depth] = 1;
+        pthread_cond_broadcast(&bench->changed);
+    }
+    pthread_mutex_unlock(&bench->lock);
+    return NULL;
+}
+
+
+// Folds a composed RGBA canvas into a running checksum
+static uint64_t hash_canvas(uint64_t hash, const gif_decoder_t* decoder, const unsigned char* rgba) {
+    size_t length = (size_t) decoder->width * (size_t) decoder->height * GIF_CHANNELS;
+    return hash * 31 + content_hash(rgba, length);
+}
+
+
+// Decodes and composes every frame with `threads` decoding threads, or all
+// on the calling thread with 0. Returns the canvas hash, or 0 on failure.
+static uint64_t decode_all(gif_decoder_t* decoder, int threads) {
+    uint64_t hash = 0;
+    gif_decoder_rewind(decoder);
+    int frame_count = decoder->frame_count;
+
+    if (threads == 0) {
+        for (int i = 0; i < frame_count; i++) {
+            const unsigned char* rgba = gif_decoder_next(decoder, NULL);
+            if (!rgba) break;
+            hash = hash_canvas(hash, decoder, rgba);
+        }
+        return hash;
+    }
+
+    decode_bench_t bench = {0};
+    bench.decoder = decoder;
+    bench.frame_count = frame_count;
+    bench.depth = 2 * threads;
+    bench.rasters = calloc(bench.depth, sizeof(*bench.rasters));
+    bench.ready = calloc(bench.depth, sizeof(*bench.ready));
+    pthread_t* workers = calloc(threads, sizeof(*workers));
+    int started = 0;
+    int ok = bench.rasters && bench.ready && workers;
+    for (int i = 0; ok && i < bench.depth; i++) {
+        ok = gif_raster_init(&bench.rasters[i], decoder);
+    }
+    pthread_mutex_init(&bench.lock, NULL);
+    pthread_cond_init(&bench.changed, NULL);
+    while (ok && started < threads && pthread_create(&workers[started], NULL, decode_bench_worker, &bench) == 0) {
+        started++;
+    }
+
+    if (started > 0) {
+        for (int i = 0; i < frame_count; i++) {
+            int slot = i % bench.depth;
+            pthread_mutex_lock(&bench.lock);
+            while (!bench.ready[slot]) {
+                pthread_cond_wait(&bench.changed, &bench.lock);
+            }
+            pthread_mutex_unlock(&bench.lock);
+
+            const unsigned char* rgba = gif_decoder_next(decoder, &bench.rasters[slot]);
+            if (rgba) hash = hash_canvas(hash, decoder, rgba);
+
+            pthread_mutex_lock(&bench.lock);
+            bench.ready[slot] = 0;
+            bench.composed++;
+            // A corrupt frame ends the animation: stop decoding past it
+            if (!rgba) bench.frame_count = bench.next;
+            pthread_cond_broadcast(&bench.changed);
+            pthread_mutex_unlock(&bench.lock);
+            if (!rgba) break;
+        }
+    }
+
+    for (int i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    for (int i = 0; bench.rasters && i < bench.depth; i++) {
+        gif_raster_free(&bench.rasters[i]);
+    }
+    pthread_mutex_destroy(&bench.lock);
+    pthread_cond_destroy(&bench.changed);
+    free(bench.rasters);
+    free(bench.ready);
+    free(workers);
+    return started > 0 ? hash : 0;
+}
+
+
+// Decodes every frame serially, then with LZW decoding on 1 to `max_workers`
+// threads, reporting throughput and whether the canvases match
+static void run_decode_bench(gif_source_t* source, int max_workers) {
+    gif_decoder_t* decoder = &source->decoder;
+    int frame_count = decoder->frame_count;
+
+    printf("GIF decode bench: %d frames, %dx%d, LZW on N threads, composition on one\n",
+           frame_count, decoder->width, decoder->height);
+    printf("  %-8s %10s %8s  %s\n", "threads", "frames/s", "speedup", "matches serial");
+
+    // An untimed pass first, so no run pays for faulting in the file
+    decode_all(decoder, 0);
+
+    double serial_rate = 0.0;
+    uint64_t serial_hash = 0;
+    for (int threads = 0; threads <= max_workers; threads++) {
+        double start = seconds_now();
+        uint64_t hash = decode_all(decoder, threads);
+        double rate = frame_count / (seconds_now() - start);
+        if (threads == 0) {
+            serial_rate = rate;
+            serial_hash = hash;
+            printf("  %-8s %10.1f %7.2fx  %s\n", "serial", rate, 1.0, "-");
+            continue;
+        }
+        if (!hash) {
+            printf("  %-8d %10s %8s  (could not start threads)\n", threads, "-", "-");
+            continue;
+        }
+        printf("  %-8d %10.1f %7.2fx  %s\n", threads, rate, rate / serial_rate,
+               hash == serial_hash ? "yes" : "NO");
+    }
+    gif_source_flush(source);
+}
+
+
+// Prepares every frame once with 1 to `max_workers` workers (0 for one per
+// core), reporting throughput, speedup over one worker and whether the
+// frames match the single-worker run. The decoder is measured on its own
+// first.
+void frame_pipeline_run_bench(gif_source_t* source, const args_t* args, int max_workers) {
+    if (max_workers <= 0) max_workers = frame_pipeline_default_workers();
+    int frame_count = source->decoder.frame_count;
+
+    run_decode_bench(source, max_workers);
+
+    printf("Frame preparation bench: %d frames, %dx%d, %ld online cores\n",
+           frame_count, source->decoder.width, source->decoder.height, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("  %-8s %10s %8s  %s\n", "workers", "frames/s", "speedup", "matches 1 worker");
+
+    double single_rate = 0.0;
+    uint64_t single_hash = 0;
+    for (int workers = 1; workers <= max_workers; workers++) {
+        // Start every run from an empty window so each one decodes all frames
+        gif_source_flush(source);
+
+        frame_pipeline_t pipeline;
+        double start = seconds_now();
+        if (!frame_pipeline_start(&pipeline, source, args, NULL, workers, 0, frame_count)) return;
+        uint64_t hash = 0;
+        for (int i = 0; i < frame_count; i++) {
+            hash = hash_frame(hash, &frame_pipeline_next(&pipeline)->image);
+            frame_pipeline_release(&pipeline);
+        }
+        double elapsed = seconds_now() - start;
+        int started = pipeline.worker_count;
+        frame_pipeline_stop(&pipeline);
+
+        double rate = frame_count / elapsed;
+        if (workers == 1) {
+            single_rate = rate;
+            single_hash = hash;
+        }
+        printf("  %-8d %10.1f %7.2fx  %s%s\n", workers, rate, rate / single_rate,
+               hash == single_hash ? "yes" : "NO", started < workers ? " (fewer threads started)" : "");
+    }
+}
@@ -0,0 +1,121 @@
+/*
+ * ASCII Image Converter - Frame Scheduler
+ *
+ * Copyright (c) 2025 danko12
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <errno.h>
+
+#include "../include/frame_scheduler.h"
+#include "../include/argparse.h"
+#include "../include/monotonic_clock.h"
+
+void frame_scheduler_init(frame_scheduler_t* scheduler, double speed, double fps_cap, int allow_skip) {
+    *scheduler = (frame_scheduler_t) {0};
+    scheduler->speed = speed > 0.0 ? speed : 1.0;
+    scheduler->min_duration_ns = fps_cap > 0.0 ? (long long) (NS_PER_SECOND / fps_cap) : 0;
+    scheduler->allow_skip = allow_skip;
+}
+
+
+// Display time of a frame with the given GIF delay, after --speed and the FPS cap
+long long frame_scheduler_duration(const frame_scheduler_t* scheduler, int delay_ms) {
+    if (delay_ms < FRAME_MIN_DELAY_MS) delay_ms = FRAME_MIN_DELAY_MS;
+    long long duration = (long long) (delay_ms * 1e6 / scheduler->speed);
+    return duration < scheduler->min_duration_ns ? scheduler->min_duration_ns : duration;
+}
+
+
+// Whether the next frame's display slot has already passed. The first frame
+// is never dropped.
+int frame_scheduler_should_drop(frame_scheduler_t* scheduler, long long duration_ns) {
+    return scheduler->allow_skip && scheduler->started &&
+           monotonic_ns() >= scheduler->deadline_ns + duration_ns;
+}
+
+
+void frame_scheduler_drop(frame_scheduler_t* scheduler, long long duration_ns) {
+    scheduler->deadline_ns += duration_ns;
+    scheduler->target_ns += duration_ns;
+    scheduler->frames_dropped++;
+}
+
+
+// Sleeps until the next frame is due; the first call starts the schedule.
+// Returns 0 if interrupted by a shutdown request.
+int frame_scheduler_wait(frame_scheduler_t* scheduler) {
+    if (!scheduler->started) {
+        scheduler->started = 1;
+        scheduler->start_ns = scheduler->deadline_ns = monotonic_ns();
+        return 1;
+    }
+
+#ifndef __APPLE__
+    struct timespec due = {
+        .tv_sec = (time_t) (scheduler->deadline_ns / NS_PER_SECOND),
+        .tv_nsec = (long) (scheduler->deadline_ns % NS_PER_SECOND),
+    };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL) == EINTR) {
+        if (g_shutdown_requested) return 0;
+    }
+#else
+    // No clock_nanosleep: sleep the remaining time relative to now
+    for (long long remaining; (remaining = scheduler->deadline_ns - monotonic_ns()) > 0;) {
+        struct timespec ts = { (time_t) (remaining / NS_PER_SECOND), (long) (remaining % NS_PER_SECOND) };
+        if (nanosleep(&ts, NULL) != 0 && g_shutdown_requested) return 0;
+    }
+#endif
+    return !g_shutdown_requested;
+}
+
+
+// Records that the frame due at the current deadline was written, and
+// schedules the next one `duration_ns` later
+void frame_scheduler_presented(frame_scheduler_t* scheduler, long long duration_ns) {
+    long long now = monotonic_ns();
+    double lateness_ms = (now - scheduler->deadline_ns) / 1e6;
+    scheduler->lateness_sum_ms += lateness_ms;
+    if (lateness_ms > scheduler->lateness_max_ms) {
+        scheduler->lateness_max_ms = lateness_ms;
+    }
+    scheduler->frames_shown++;
+    scheduler->target_ns += duration_ns;
+
+    scheduler->deadline_ns += duration_ns;
+    if (!scheduler->allow_skip && now > scheduler->deadline_ns) {
+        // Too far behind to catch up without rushing: restart from now
+        scheduler->deadline_ns = now;
+        scheduler->resyncs++;
+    }
+}
+
+
+void frame_scheduler_report(const frame_scheduler_t* scheduler) {
+    if (!scheduler->frames_shown) return;
+    long long elapsed_ns = monotonic_ns() - scheduler->start_ns;
+    double drift_ms = (elapsed_ns - scheduler->target_ns) / 1e6;
+    fprintf(stderr, "[debug] frame timing: %ld shown, %ld dropped, %ld resyncs; lateness mean %.2f ms, max %.2f ms\n",
+            scheduler->frames_shown, scheduler->frames_dropped, scheduler->resyncs,
+            scheduler->lateness_sum_ms / scheduler->frames_shown, scheduler->lateness_max_ms);
+    fprintf(stderr, "[debug] playback: %.3f s achieved vs %.3f s target (%+.2f ms)\n",
+            elapsed_ns / 1e9, scheduler->target_ns / 1e9, drift_ms);
+}
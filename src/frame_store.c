@@ -0,0 +1,240 @@
+/*
+ * ASCII Image Converter - Packed Frame Store
+ *
+ * Copyright (c) 2025 danko12
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "../include/frame_store.h"
+
+// Patch header: the frame's cells follow as runs over the previous grid, or
+// its size and then runs over an empty grid of that size
+#define PATCH_OVER_PREVIOUS 0
+#define PATCH_WHOLE 1
+
+// Longest LEB128 encoding of a size_t
+#define VARINT_MAX_BYTES 10
+#define PACKED_CELL_BYTES 4
+
+
+// Returns 0 if out of memory
+int frame_store_init(frame_store_t* store, int frame_count) {
+    memset(store, 0, sizeof(*store));
+    frame_buffer_init(&store->data);
+    store->frames = calloc(frame_count, sizeof(*store->frames));
+    store->frame_count = store->frames ? frame_count : 0;
+    return store->frames != NULL;
+}
+
+
+// Drops every frame, keeping the glyph table, and makes room for
+// `frame_count` of them, at most as many as before
+void frame_store_reset(frame_store_t* store, int frame_count) {
+    frame_buffer_reset(&store->data);
+    store->cells = 0;
+    store->shared = 0;
+    if (frame_count < store->frame_count) {
+        stored_frame_t* frames = realloc(store->frames, (frame_count ? frame_count : 1) * sizeof(*frames));
+        store->heap_allocations++;
+        if (frames) store->frames = frames;
+        store->frame_count = frame_count;
+    }
+    memset(store->frames, 0, store->frame_count * sizeof(*store->frames));
+}
+
+
+void frame_store_shrink(frame_store_t* store) {
+    frame_buffer_shrink(&store->data);
+}
+
+
+void frame_store_free(frame_store_t* store) {
+    frame_buffer_free(&store->data);
+    free(store->frames);
+    store->frames = NULL;
+    store->frame_count = 0;
+}
+
+
+static void put_varint(frame_buffer_t* output, size_t value) {
+    while (value >= 0x80) {
+        output->data[output->length++] = (char) ((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    output->data[output->length++] = (char) value;
+}
+
+
+static size_t varint_length(size_t value) {
+    size_t length = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        length++;
+    }
+    return length;
+}
+
+
+static size_t get_varint(const unsigned char** bytes) {
+    size_t value = 0;
+    int shift = 0;
+    const unsigned char* p = *bytes;
+    do {
+        value |= (size_t) (*p & 0x7F) << shift;
+        shift += 7;
+    } while (*p++ & 0x80);
+    *bytes = p;
+    return value;
+}
+
+
+// Glyph id of a cell, added to the table if new. Returns -1 when full.
+static int glyph_id(frame_store_t* store, const cell_t* cell) {
+    uint32_t bytes;
+    memcpy(&bytes, cell->glyph, sizeof(bytes));
+    uint64_t key = (uint64_t) bytes | (uint64_t) cell->length << 32;
+    size_t slot = (size_t) ((key * 0x9E3779B97F4A7C15ULL) >> 55) & (FRAME_STORE_GLYPH_SLOTS - 1);
+
+    while (store->glyph_slots[slot]) {
+        const cell_t* glyph = &store->glyphs[store->glyph_slots[slot] - 1];
+        if (glyph->length == cell->length && memcmp(glyph->glyph, cell->glyph, GLYPH_MAX_BYTES) == 0) {
+            return store->glyph_slots[slot] - 1;
+        }
+        slot = (slot + 1) & (FRAME_STORE_GLYPH_SLOTS - 1);
+    }
+    if (store->glyph_count == FRAME_STORE_GLYPHS) return -1;
+
+    cell_t* glyph = &store->glyphs[store->glyph_count];
+    memset(glyph, 0, sizeof(*glyph));
+    glyph->length = cell->length;
+    memcpy(glyph->glyph, cell->glyph, GLYPH_MAX_BYTES);
+    store->glyph_slots[slot] = (uint16_t) ++store->glyph_count;
+    return store->glyph_count - 1;
+}
+
+
+// Stores `current` as frame `index`, a patch over `previous` (NULL if
+// nothing was played before it). Frames with equal nonzero keys, such as
+// the same canvas after the same canvas, are looked up to share the patch
+// if its bytes match. Returns 0 if out of memory or out of glyph ids; the
+// frame is then not stored.
+int frame_store_put(frame_store_t* store, int index, uint64_t key, const cell_grid_t* previous,
+                    const cell_grid_t* current) {
+    size_t width = current->width;
+    size_t height = current->height;
+    size_t count = width * height;
+    int whole = !previous || previous->width != width || previous->height != height;
+
+    frame_buffer_t* data = &store->data;
+    // Runs are at least a cell long and a cell apart, and no offset or
+    // length exceeds the cell count
+    size_t runs = count / 2 + 1;
+    size_t worst = 1 + 2 * VARINT_MAX_BYTES + count * PACKED_CELL_BYTES + runs * 2 * varint_length(count);
+    if (!frame_buffer_reserve(data, worst)) return 0;
+    size_t offset = data->length;
+
+    data->data[data->length++] = whole ? PATCH_WHOLE : PATCH_OVER_PREVIOUS;
+    if (whole) {
+        put_varint(data, width);
+        put_varint(data, height);
+    }
+
+    size_t i = 0, last = 0, cells = 0;
+    while (i < count) {
+        if (!whole && cell_equal(&previous->cells[i], &current->cells[i])) {
+            i++;
+            continue;
+        }
+        size_t end = i + 1;
+        while (end < count && (whole || !cell_equal(&previous->cells[end], &current->cells[end]))) {
+            end++;
+        }
+        put_varint(data, i - last);
+        put_varint(data, end - i);
+        cells += end - i;
+        for (; i < end; i++) {
+            const cell_t* cell = &current->cells[i];
+            int id = glyph_id(store, cell);
+            if (id < 0) {
+                data->length = offset;
+                return 0;
+            }
+            unsigned char* packed = (unsigned char*) data->data + data->length;
+            memcpy(packed, cell->rgb, 3);
+            packed[3] = (unsigned char) id;
+            data->length += PACKED_CELL_BYTES;
+        }
+        last = end;
+    }
+
+    size_t length = data->length - offset;
+    for (int j = 0; key && j < store->frame_count; j++) {
+        const stored_frame_t* earlier = &store->frames[j];
+        if (j != index && earlier->key == key && earlier->length == length &&
+            memcmp(data->data + earlier->offset, data->data + offset, length) == 0) {
+            data->length = offset;
+            store->frames[index] = *earlier;
+            store->shared++;
+            return 1;
+        }
+    }
+
+    store->cells += cells;
+    store->frames[index].offset = offset;
+    store->frames[index].length = length;
+    store->frames[index].key = key;
+    return 1;
+}
+
+
+// Brings `grid`, the frame played before `index`, up to that frame.
+// Returns the number of cells written, 0 for a repeat of the frame before,
+// or -1 if the frame is not stored or the grid cannot be resized.
+long frame_store_apply(const frame_store_t* store, int index, cell_grid_t* grid) {
+    const stored_frame_t* frame = &store->frames[index];
+    if (frame->length == 0) return -1;
+
+    const unsigned char* p = (const unsigned char*) store->data.data + frame->offset;
+    const unsigned char* end = p + frame->length;
+    if (*p++ == PATCH_WHOLE) {
+        size_t width = get_varint(&p);
+        size_t height = get_varint(&p);
+        if (!cell_grid_resize(grid, width, height)) return -1;
+    }
+
+    size_t count = grid->width * grid->height;
+    size_t i = 0;
+    long written = 0;
+    while (p < end) {
+        i += get_varint(&p);
+        size_t run = get_varint(&p);
+        if (i + run > count) return -1;
+        for (size_t stop = i + run; i < stop; i++, p += PACKED_CELL_BYTES) {
+            cell_t* cell = &grid->cells[i];
+            *cell = store->glyphs[p[3]];
+            memcpy(cell->rgb, p, 3);
+        }
+        written += (long) run;
+    }
+    return written;
+}
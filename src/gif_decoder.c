@@ -0,0 +1,944 @@
+/*
+ * ASCII Image Converter - GIF Decoder
+ *
+ * Copyright (c) 2025 danko12
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../include/gif_decoder.h"
+#include "../include/content_hash.h"
+
+// LZW string table entry: the string is the prefix's string plus `suffix`
+struct gif_lzw_entry {
+    int16_t prefix;
+    uint8_t first;
+    uint8_t suffix;
+    uint16_t length;
+};
+
+#define GIF_LZW_TABLE_SIZE 8192
+
+
+// ============================================================================
+// Block Structure Scan
+// ============================================================================
+
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+    size_t pos;
+} gif_reader_t;
+
+
+// Returns the next byte, or -1 at the end of the file
+static int read_byte(gif_reader_t* reader) {
+    return reader->pos < reader->size ? reader->data[reader->pos++] : -1;
+}
+
+static int read_u16(gif_reader_t* reader) {
+    int low = read_byte(reader);
+    int high = read_byte(reader);
+    return (low < 0 || high < 0) ? -1 : low | (high << 8);
+}
+
+static int skip_bytes(gif_reader_t* reader, size_t count) {
+    if (reader->size - reader->pos < count) {
+        reader->pos = reader->size;
+        return 0;
+    }
+    reader->pos += count;
+    return 1;
+}
+
+// Skips data sub-blocks up to and including the zero-length terminator
+static int skip_sub_blocks(gif_reader_t* reader) {
+    for (;;) {
+        int length = read_byte(reader);
+        if (length <= 0) return length == 0;
+        if (!skip_bytes(reader, (size_t) length)) return 0;
+    }
+}
+
+
+static int add_frame(gif_decoder_t* decoder, int* capacity, const gif_frame_info_t* info) {
+    if (decoder->frame_count == *capacity) {
+        int grown = *capacity ? *capacity * 2 : 16;
+        gif_frame_info_t* frames = realloc(decoder->frames, (size_t) grown * sizeof(*frames));
+        if (!frames) return 0;
+        decoder->frames = frames;
+        *capacity = grown;
+    }
+    decoder->frames[decoder->frame_count++] = *info;
+    return 1;
+}
+
+
+// Indexes every frame. Like stb_image, a malformed block ends the animation
+// after the frames before it; an error is only reported when none remain.
+static int scan_frames(gif_decoder_t* decoder) {
+    gif_reader_t reader = { decoder->data, decoder->size, 0 };
+    if (decoder->size < 13 || memcmp(decoder->data, "GIF8", 4) != 0 ||
+        (decoder->data[4] != '7' && decoder->data[4] != '9') || decoder->data[5] != 'a') {
+        fprintf(stderr, "Error: Failed to load GIF animation: not GIF\n");
+        return 0;
+    }
+    reader.pos = 6;
+
+    decoder->width = read_u16(&reader);
+    decoder->height = read_u16(&reader);
+    int flags = read_byte(&reader);
+    decoder->background_index = read_byte(&reader);
+    read_byte(&reader); // pixel aspect ratio
+
+    if (flags & 0x80) {
+        int entries = 2 << (flags & 7);
+        if (decoder->size - reader.pos < (size_t) entries * 3) {
+            fprintf(stderr, "Error: Failed to load GIF animation: Corrupt GIF\n");
+            return 0;
+        }
+        for (int i = 0; i < entries; i++) {
+            decoder->global_palette[i][0] = decoder->data[reader.pos++];
+            decoder->global_palette[i][1] = decoder->data[reader.pos++];
+            decoder->global_palette[i][2] = decoder->data[reader.pos++];
+            decoder->global_palette[i][3] = 255;
+        }
+        decoder->has_global_palette = 1;
+    }
+
+    // Graphic control state carries over to later frames until replaced
+    int control_flags = 0;
+    int transparent = -1;
+    int delay = 0;
+    int capacity = 0;
+
+    for (int done = 0; !done;) {
+        switch (read_byte(&reader)) {
+            case 0x2C: { // Image Descriptor
+                gif_frame_info_t info = {0};
+                info.left = read_u16(&reader);
+                info.top = read_u16(&reader);
+                info.width = read_u16(&reader);
+                info.height = read_u16(&reader);
+                int local_flags = read_byte(&reader);
+                if (local_flags < 0 || info.left + info.width > decoder->width ||
+                    info.top + info.height > decoder->height) {
+                    done = 1;
+                    break;
+                }
+                info.interlaced = (local_flags & 0x40) != 0;
+
+                if (local_flags & 0x80) {
+                    info.palette_offset = reader.pos;
+                    info.palette_size = 2 << (local_flags & 7);
+                    if (!skip_bytes(&reader, (size_t) info.palette_size * 3)) {
+                        done = 1;
+                        break;
+                    }
+                } else if (!decoder->has_global_palette) {
+                    done = 1;
+                    break;
+                }
+
+                info.raster_offset = reader.pos;
+                if (read_byte(&reader) < 0 || !skip_sub_blocks(&reader)) {
+                    done = 1;
+                    break;
+                }
+
+                info.control_flags = control_flags;
+                info.transparent = transparent;
+                info.delay = delay;
+                if ((control_flags & 0x1C) >> 2 == 3) {
+                    decoder->restores_previous = 1;
+                }
+                if (!add_frame(decoder, &capacity, &info)) {
+                    fprintf(stderr, "Error: Failed to allocate GIF frame index!\n");
+                    return 0;
+                }
+                break;
+            }
+
+            case 0x21: { // Extension
+                int label = read_byte(&reader);
+                if (label == 0xF9) { // Graphic Control Extension
+                    int length = read_byte(&reader);
+                    if (length == 4) {
+                        control_flags = read_byte(&reader);
+                        delay = 10 * read_u16(&reader);
+                        int index = read_byte(&reader);
+                        transparent = (control_flags & 0x01) ? index : -1;
+                    } else if (length > 0) {
+                        skip_bytes(&reader, (size_t) length);
+                    }
+                }
+                if (label < 0 || !skip_sub_blocks(&reader)) {
+                    done = 1;
+                }
+                break;
+            }
+
+            default: // Trailer (0x3B), unknown block or end of file
+                done = 1;
+                break;
+        }
+    }
+
+    if (decoder->frame_count == 0) {
+        fprintf(stderr, "Error: Failed to load GIF animation: no frames\n");
+        return 0;
+    }
+    return 1;
+}
+
+
+// ============================================================================
+// LZW Raster Decoding
+// ============================================================================
+
+// Decodes one frame's raster into palette indices in stream order, at most
+// width * height of them. Returns the count, or -1 for a corrupt stream.
+// Depends only on the file bytes, so frames can be decoded independently.
+static long decode_raster(const unsigned char* data, size_t size, const gif_frame_info_t* info,
+                          gif_lzw_entry_t* table, unsigned char* indices) {
+    size_t pos = info->raster_offset;
+    size_t capacity = (size_t) info->width * (size_t) info->height;
+    size_t count = 0;
+
+    if (pos >= size) return -1;
+    int minimum_size = data[pos++];
+    if (minimum_size > 12) return -1;
+
+    int clear = 1 << minimum_size;
+    int code_size = minimum_size + 1;
+    int code_mask = (1 << code_size) - 1;
+    int available = clear + 2;
+    int previous = -1;
+    for (int code = 0; code < clear; code++) {
+        table[code].prefix = -1;
+        table[code].first = (uint8_t) code;
+        table[code].suffix = (uint8_t) code;
+        table[code].length = 1;
+    }
+
+    uint32_t bits = 0;
+    int valid_bits = 0;
+    size_t block_left = 0;
+
+    for (;;) {
+        if (valid_bits < code_size) {
+            // A missing terminator or end of file ends the raster, as in stb_image
+            if (block_left == 0) {
+                if (pos >= size || data[pos] == 0) return (long) count;
+                block_left = data[pos++];
+            }
+            if (pos >= size) return (long) count;
+            block_left--;
+            bits |= (uint32_t) data[pos++] << valid_bits;
+            valid_bits += 8;
+            continue;
+        }
+
+        int code = (int) (bits & (uint32_t) code_mask);
+        bits >>= code_size;
+        valid_bits -= code_size;
+
+        if (code == clear) {
+            code_size = minimum_size + 1;
+            code_mask = (1 << code_size) - 1;
+            available = clear + 2;
+            previous = -1;
+            continue;
+        }
+        if (code == clear + 1) {
+            return (long) count;
+        }
+        if (code > available) {
+            return -1;
+        }
+
+        if (previous >= 0) {
+            if (available >= GIF_LZW_TABLE_SIZE) return -1;
+            gif_lzw_entry_t* entry = &table[available++];
+            entry->prefix = (int16_t) previous;
+            entry->first = table[previous].first;
+            entry->suffix = (code == available - 1) ? entry->first : table[code].first;
+            entry->length = (uint16_t) (table[previous].length + 1);
+        } else if (code == available) {
+            return -1;
+        }
+
+        // Write the string back to front by following its prefixes
+        if (count < capacity) {
+            size_t end = count + table[code].length;
+            int node = code;
+            for (size_t k = end; k > count; node = table[node].prefix) {
+                k--;
+                if (k < capacity) indices[k] = table[node].suffix;
+            }
+            count = end < capacity ? end : capacity;
+        }
+
+        if ((available & code_mask) == 0 && available <= 0x0FFF) {
+            code_size++;
+            code_mask = (1 << code_size) - 1;
+        }
+        previous = code;
+    }
+}
+
+
+// Sizes a raster for any frame of `decoder`. Returns 0 if out of memory.
+int gif_raster_init(gif_raster_t* raster, const gif_decoder_t* decoder) {
+    raster->frame = -1;
+    raster->count = 0;
+    raster->indices = malloc((size_t) decoder->width * (size_t) decoder->height);
+    raster->table = malloc(GIF_LZW_TABLE_SIZE * sizeof(*raster->table));
+    if (!raster->indices || !raster->table) {
+        gif_raster_free(raster);
+        return 0;
+    }
+    return 1;
+}
+
+
+// Decodes frame `index` into `raster`. Only reads the file and the frame
+// index, so it may run while another thread composes other frames.
+void gif_raster_decode(gif_raster_t* raster, const gif_decoder_t* decoder, int index) {
+    raster->count = decode_raster(decoder->data, decoder->size, &decoder->frames[index], raster->table,
+                                  raster->indices);
+    raster->frame = index;
+}
+
+
+void gif_raster_free(gif_raster_t* raster) {
+    free(raster->indices);
+    free(raster->table);
+    raster->indices = NULL;
+    raster->table = NULL;
+    raster->frame = -1;
+}
+
+
+// ============================================================================
+// Frame Composition
+// ============================================================================
+
+int gif_decoder_open(gif_decoder_t* decoder, const media_file_t* file) {
+    memset(decoder, 0, sizeof(*decoder));
+    decoder->data = file->data;
+    decoder->size = file->size;
+
+    if (!scan_frames(decoder)) {
+        gif_decoder_close(decoder);
+        return 0;
+    }
+
+    decoder->playable_frames = decoder->frame_count;
+    for (int i = 0; i < decoder->frame_count; i++) {
+        gif_frame_info_t* info = &decoder->frames[i];
+        info->changed_left = info->changed_top = 0;
+        info->changed_right = decoder->width;
+        info->changed_bottom = decoder->height;
+    }
+    decoder->composed = -1;
+
+    size_t pixels = (size_t) decoder->width * (size_t) decoder->height;
+    decoder->canvas = malloc(pixels * GIF_CHANNELS);
+    decoder->background = malloc(pixels * GIF_CHANNELS);
+    decoder->before = malloc(pixels * GIF_CHANNELS);
+    decoder->history = malloc(pixels);
+    int buffers_ok = gif_raster_init(&decoder->raster, decoder) && decoder->canvas && decoder->background &&
+                     decoder->before && decoder->history;
+    if (decoder->restores_previous) {
+        decoder->previous[0] = malloc(pixels * GIF_CHANNELS);
+        decoder->previous[1] = malloc(pixels * GIF_CHANNELS);
+        buffers_ok = buffers_ok && decoder->previous[0] && decoder->previous[1];
+    }
+    if (!buffers_ok) {
+        fprintf(stderr, "Error: Failed to allocate GIF decoder buffers!\n");
+        gif_decoder_close(decoder);
+        return 0;
+    }
+    return 1;
+}
+
+
+// Draws a frame's indices over the canvas in stream order. Interlaced rows
+// arrive in four passes: every 8th row from 0, every 8th from 4, every 4th
+// from 2, then every 2nd from 1.
+static void draw_indices(gif_decoder_t* decoder, const gif_frame_info_t* info,
+                         unsigned char palette[256][4], const unsigned char* indices, size_t count) {
+    static const int pass_start[4] = { 0, 4, 2, 1 };
+    static const int pass_step[4] = { 8, 8, 4, 2 };
+    int passes = info->interlaced ? 4 : 1;
+    size_t n = 0;
+
+    for (int pass = 0; pass < passes; pass++) {
+        int start = info->interlaced ? pass_start[pass] : 0;
+        int step = info->interlaced ? pass_step[pass] : 1;
+        for (int row = start; row < info->height && n < count; row += step) {
+            size_t p = (size_t) (info->top + row) * (size_t) decoder->width + (size_t) info->left;
+            for (int column = 0; column < info->width && n < count; column++, p++) {
+                const unsigned char* color = palette[indices[n++]];
+                decoder->history[p] = 1;
+                if (color[3] > 128) {
+                    memcpy(&decoder->canvas[p * GIF_CHANNELS], color, GIF_CHANNELS);
+                }
+            }
+        }
+    }
+}
+
+
+// Grows the rectangle [*left, *right) x [*top, *bottom) to cover a frame's
+static void cover_frame(const gif_frame_info_t* info, int* left, int* top, int* right, int* bottom) {
+    if (info->width == 0 || info->height == 0) return;
+    if (*right <= *left || *bottom <= *top) {
+        *left = info->left;
+        *top = info->top;
+        *right = info->left + info->width;
+        *bottom = info->top + info->height;
+        return;
+    }
+    if (info->left < *left) *left = info->left;
+    if (info->top < *top) *top = info->top;
+    if (info->left + info->width > *right) *right = info->left + info->width;
+    if (info->top + info->height > *bottom) *bottom = info->top + info->height;
+}
+
+
+// Records in `info` the bounding box of the pixels inside the saved
+// rectangle that composing changed
+static void find_changes(const gif_decoder_t* decoder, gif_frame_info_t* info,
+                         int left, int top, int right, int bottom) {
+    int changed_left = right, changed_right = left;
+    int changed_top = bottom, changed_bottom = top;
+    for (int y = top; y < bottom; y++) {
+        size_t offset = ((size_t) y * (size_t) decoder->width + (size_t) left) * GIF_CHANNELS;
+        const unsigned char* now = decoder->canvas + offset;
+        const unsigned char* was = decoder->before + offset;
+        size_t length = (size_t) (right - left) * GIF_CHANNELS;
+        if (memcmp(now, was, length) == 0) continue;
+
+        int first = 0, last = right - left - 1;
+        while (memcmp(now + (size_t) first * GIF_CHANNELS, was + (size_t) first * GIF_CHANNELS, GIF_CHANNELS) == 0) {
+            first++;
+        }
+        while (memcmp(now + (size_t) last * GIF_CHANNELS, was + (size_t) last * GIF_CHANNELS, GIF_CHANNELS) == 0) {
+            last--;
+        }
+        if (left + first < changed_left) changed_left = left + first;
+        if (left + last + 1 > changed_right) changed_right = left + last + 1;
+        if (y < changed_top) changed_top = y;
+        changed_bottom = y + 1;
+    }
+
+    if (changed_right <= changed_left) {
+        changed_left = changed_right = changed_top = changed_bottom = 0;
+    }
+    info->changed_left = changed_left;
+    info->changed_top = changed_top;
+    info->changed_right = changed_right;
+    info->changed_bottom = changed_bottom;
+}
+
+
+// ============================================================================
+// Seek Index
+// ============================================================================
+
+// Run-length codes RGBA pixels. A header byte h < 128 is followed by h + 1
+// literal pixels; h >= 128 by one pixel repeated h - 126 times. Needs room
+// for pixels * 4 + pixels / 128 + 1 bytes. Returns the coded size.
+static size_t pack_pixels(const unsigned char* rgba, size_t pixels, unsigned char* out) {
+    size_t length = 0;
+    size_t i = 0;
+    while (i < pixels) {
+        size_t run = 1;
+        while (i + run < pixels && run < 129 &&
+               memcmp(rgba + (i + run) * GIF_CHANNELS, rgba + i * GIF_CHANNELS, GIF_CHANNELS) == 0) {
+            run++;
+        }
+        if (run >= 2) {
+            out[length++] = (unsigned char) (run + 126);
+            memcpy(out + length, rgba + i * GIF_CHANNELS, GIF_CHANNELS);
+            length += GIF_CHANNELS;
+            i += run;
+            continue;
+        }
+
+        // Literals up to the next repeated pixel
+        size_t count = 1;
+        while (i + count < pixels && count < 128 &&
+               (i + count + 1 >= pixels || memcmp(rgba + (i + count) * GIF_CHANNELS,
+                                                   rgba + (i + count + 1) * GIF_CHANNELS, GIF_CHANNELS) != 0)) {
+            count++;
+        }
+        out[length++] = (unsigned char) (count - 1);
+        memcpy(out + length, rgba + i * GIF_CHANNELS, count * GIF_CHANNELS);
+        length += count * GIF_CHANNELS;
+        i += count;
+    }
+    return length;
+}
+
+
+static void unpack_pixels(const unsigned char* packed, size_t length, unsigned char* rgba) {
+    size_t pos = 0;
+    while (pos < length) {
+        int header = packed[pos++];
+        if (header < 128) {
+            size_t bytes = (size_t) (header + 1) * GIF_CHANNELS;
+            memcpy(rgba, packed + pos, bytes);
+            rgba += bytes;
+            pos += bytes;
+        } else {
+            for (int k = 0; k < header - 126; k++, rgba += GIF_CHANNELS) {
+                memcpy(rgba, packed + pos, GIF_CHANNELS);
+            }
+            pos += GIF_CHANNELS;
+        }
+    }
+}
+
+
+// Codes `rgba` into a buffer of its own. Returns NULL if out of memory.
+static unsigned char* pack_canvas(gif_decoder_t* decoder, const unsigned char* rgba, size_t* size) {
+    size_t pixels = (size_t) decoder->width * (size_t) decoder->height;
+    unsigned char* packed = malloc(pixels * GIF_CHANNELS + pixels / 128 + 1);
+    decoder->heap_allocations++;
+    if (!packed) return NULL;
+    *size = pack_pixels(rgba, pixels, packed);
+    unsigned char* shrunk = realloc(packed, *size ? *size : 1);
+    decoder->heap_allocations++;
+    return shrunk ? shrunk : packed;
+}
+
+
+static void free_keyframe(gif_decoder_t* decoder, gif_keyframe_t* keyframe) {
+    decoder->keyframe_bytes -= keyframe->canvas_size + keyframe->previous_size;
+    free(keyframe->canvas);
+    free(keyframe->previous);
+    memset(keyframe, 0, sizeof(*keyframe));
+}
+
+
+// Doubles the keyframe spacing, dropping the snapshots between the new ones
+static void thin_keyframes(gif_decoder_t* decoder) {
+    decoder->keyframe_spacing *= 2;
+    int step = decoder->keyframe_spacing / GIF_KEYFRAME_INTERVAL;
+    for (int k = 1; k <= decoder->frame_count / GIF_KEYFRAME_INTERVAL; k++) {
+        if (k % step != 0 && decoder->keyframes[k].canvas) {
+            free_keyframe(decoder, &decoder->keyframes[k]);
+        }
+    }
+}
+
+
+// Snapshots the state before frame `index` is drawn, if it starts an
+// interval and has no snapshot yet. The canvas has had the previous frame
+// disposed; previous[0] still holds that frame composed. Over budget, the
+// snapshots are spaced out while the new one stays on the spacing, and it
+// is not kept if it still does not fit.
+static void take_keyframe(gif_decoder_t* decoder, int index) {
+    if (!decoder->keyframes || index % decoder->keyframe_spacing != 0) return;
+    gif_keyframe_t* keyframe = &decoder->keyframes[index / GIF_KEYFRAME_INTERVAL];
+    if (keyframe->canvas) return;
+
+    gif_keyframe_t taken = {0};
+    int restores = (decoder->frames[index].control_flags & 0x1C) >> 2 == 3 && decoder->restores_previous;
+    taken.canvas = pack_canvas(decoder, decoder->canvas, &taken.canvas_size);
+    if (taken.canvas && restores) {
+        taken.previous = pack_canvas(decoder, decoder->previous[0], &taken.previous_size);
+        if (!taken.previous) {
+            free(taken.canvas);
+            return;
+        }
+    }
+    if (!taken.canvas) return;
+
+    size_t size = taken.canvas_size + taken.previous_size;
+    while (decoder->keyframe_bytes + size > decoder->keyframe_budget &&
+           index % (decoder->keyframe_spacing * 2) == 0) {
+        thin_keyframes(decoder);
+    }
+    if (decoder->keyframe_bytes + size > decoder->keyframe_budget) {
+        free(taken.canvas);
+        free(taken.previous);
+        return;
+    }
+    *keyframe = taken;
+    decoder->keyframe_bytes += size;
+}
+
+
+// Starts snapshotting composition every GIF_KEYFRAME_INTERVAL frames, so
+// gif_decoder_seek() can resume near any frame. The snapshots are kept
+// within `budget` bytes. Returns 0 if out of memory.
+int gif_decoder_enable_seek(gif_decoder_t* decoder, size_t budget) {
+    if (decoder->keyframes) return 1;
+    decoder->keyframes = calloc((size_t) decoder->frame_count / GIF_KEYFRAME_INTERVAL + 1,
+                                sizeof(*decoder->keyframes));
+    decoder->keyframe_budget = budget;
+    decoder->keyframe_spacing = GIF_KEYFRAME_INTERVAL;
+    return decoder->keyframes != NULL;
+}
+
+
+// Positions the decoder so that gif_decoder_next() composes frame `index`
+// next. Composition resumes from the last snapshot at or before it, unless
+// the decoder's position is already between the two.
+void gif_decoder_seek(gif_decoder_t* decoder, int index) {
+    int key = 0;
+    for (int k = index / GIF_KEYFRAME_INTERVAL; decoder->keyframes && k > 0; k--) {
+        if (decoder->keyframes[k].canvas) {
+            key = k * GIF_KEYFRAME_INTERVAL;
+            break;
+        }
+    }
+    if (decoder->next_frame <= index && decoder->next_frame >= key) return;
+    if (key == 0) {
+        gif_decoder_rewind(decoder);
+        return;
+    }
+
+    // With no pixels marked as drawn, disposing of the frame before does nothing
+    const gif_keyframe_t* keyframe = &decoder->keyframes[key / GIF_KEYFRAME_INTERVAL];
+    unpack_pixels(keyframe->canvas, keyframe->canvas_size, decoder->canvas);
+    if (keyframe->previous) {
+        unpack_pixels(keyframe->previous, keyframe->previous_size, decoder->previous[0]);
+    }
+    memset(decoder->history, 0, (size_t) decoder->width * (size_t) decoder->height);
+    decoder->next_frame = key;
+    decoder->composed = -1;
+}
+
+
+// Decodes and composes the next frame. Its LZW output is taken from
+// `decoded` when that holds it, so decoding can happen on other threads;
+// otherwise, or with NULL, it is decoded here. Returns the RGBA canvas,
+// valid until the next call, or NULL at the end. A corrupt frame ends the
+// animation there: `playable_frames` drops to its index.
+const unsigned char* gif_decoder_next(gif_decoder_t* decoder, const gif_raster_t* decoded) {
+    if (decoder->next_frame >= decoder->playable_frames) {
+        return NULL;
+    }
+
+    int index = decoder->next_frame;
+    gif_frame_info_t* info = &decoder->frames[index];
+    size_t pixels = (size_t) decoder->width * (size_t) decoder->height;
+
+    // Save the pixels this frame can change while the canvas still shows the
+    // frame before it: its own rectangle and the one its predecessor's
+    // disposal restores. Frame 0 starts from a cleared canvas.
+    int left = 0, top = 0, right = 0, bottom = 0;
+    int previous = index > 0 ? index - 1 : decoder->playable_frames - 1;
+    int track = decoder->composed == previous && decoder->playable_frames > 1;
+    if (track && index == 0) {
+        right = decoder->width;
+        bottom = decoder->height;
+    } else if (track) {
+        int previous_dispose = (decoder->frames[previous].control_flags & 0x1C) >> 2;
+        if (previous_dispose == 2 || previous_dispose == 3) {
+            cover_frame(&decoder->frames[previous], &left, &top, &right, &bottom);
+        }
+        cover_frame(info, &left, &top, &right, &bottom);
+    }
+    for (int y = top; y < bottom; y++) {
+        size_t offset = ((size_t) y * (size_t) decoder->width + (size_t) left) * GIF_CHANNELS;
+        memcpy(decoder->before + offset, decoder->canvas + offset, (size_t) (right - left) * GIF_CHANNELS);
+    }
+
+    if (index == 0) {
+        memset(decoder->canvas, 0, pixels * GIF_CHANNELS);
+        memset(decoder->background, 0, pixels * GIF_CHANNELS);
+        memset(decoder->history, 0, pixels);
+    } else {
+        // Dispose of the previous frame's pixels as its control block asks
+        int dispose = (decoder->frames[index - 1].control_flags & 0x1C) >> 2;
+        const unsigned char* two_back = index >= 2 ? decoder->previous[1] : NULL;
+        if (dispose == 3 && !two_back) {
+            dispose = 2;
+        }
+        if (dispose == 3 || dispose == 2) {
+            const unsigned char* restore = dispose == 3 ? two_back : decoder->background;
+            for (size_t p = 0; p < pixels; p++) {
+                if (decoder->history[p]) {
+                    memcpy(&decoder->canvas[p * GIF_CHANNELS], &restore[p * GIF_CHANNELS], GIF_CHANNELS);
+                }
+            }
+        }
+        memcpy(decoder->background, decoder->canvas, pixels * GIF_CHANNELS);
+        take_keyframe(decoder, index);
+    }
+    memset(decoder->history, 0, pixels);
+
+    // Color table with the transparent entry cleared
+    unsigned char palette[256][4];
+    int transparent = info->transparent;
+    if (info->palette_offset) {
+        const unsigned char* rgb = decoder->data + info->palette_offset;
+        if (!(info->control_flags & 0x01)) transparent = -1;
+        memset(palette, 0, sizeof(palette));
+        for (int i = 0; i < info->palette_size; i++) {
+            palette[i][0] = rgb[i * 3];
+            palette[i][1] = rgb[i * 3 + 1];
+            palette[i][2] = rgb[i * 3 + 2];
+            palette[i][3] = 255;
+        }
+    } else {
+        memcpy(palette, decoder->global_palette, sizeof(palette));
+    }
+    if (transparent >= 0) {
+        palette[transparent][3] = 0;
+    }
+
+    if (!decoded || decoded->frame != index) {
+        gif_raster_decode(&decoder->raster, decoder, index);
+        decoded = &decoder->raster;
+    }
+    long count = decoded->count;
+    if (count < 0) {
+        fprintf(stderr, "Warning: GIF frame %d is corrupt, ending animation there\n", index + 1);
+        decoder->playable_frames = index;
+        decoder->composed = -1;
+        return NULL;
+    }
+    draw_indices(decoder, info, palette, decoded->indices, (size_t) count);
+
+    // On the first frame, pixels no frame drew take the background color
+    if (index == 0 && decoder->background_index > 0) {
+        unsigned char color[4];
+        memcpy(color, decoder->global_palette[decoder->background_index], 3);
+        color[3] = 255;
+        for (size_t p = 0; p < pixels; p++) {
+            if (!decoder->history[p]) {
+                memcpy(&decoder->canvas[p * GIF_CHANNELS], color, GIF_CHANNELS);
+            }
+        }
+    }
+
+    // Keep the canvases "restore to previous" disposal can return to
+    if (decoder->restores_previous) {
+        unsigned char* oldest = decoder->previous[1];
+        memcpy(oldest, decoder->canvas, pixels * GIF_CHANNELS);
+        decoder->previous[1] = decoder->previous[0];
+        decoder->previous[0] = oldest;
+    }
+
+    if (track) {
+        find_changes(decoder, info, left, top, right, bottom);
+    }
+    // A frame composes to the same canvas every time, so once is enough
+    if (!info->hash) {
+        info->hash = content_hash(decoder->canvas, pixels * GIF_CHANNELS);
+    }
+    decoder->composed = index;
+    decoder->next_frame++;
+    return decoder->canvas;
+}
+
+
+// Restarts at the first frame; the index is kept
+void gif_decoder_rewind(gif_decoder_t* decoder) {
+    decoder->next_frame = 0;
+}
+
+
+void gif_decoder_close(gif_decoder_t* decoder) {
+    free(decoder->frames);
+    free(decoder->canvas);
+    free(decoder->background);
+    free(decoder->before);
+    free(decoder->history);
+    free(decoder->previous[0]);
+    free(decoder->previous[1]);
+    gif_raster_free(&decoder->raster);
+    int keyframes = decoder->frame_count / GIF_KEYFRAME_INTERVAL + 1;
+    for (int i = 0; decoder->keyframes && i < keyframes; i++) {
+        free(decoder->keyframes[i].canvas);
+        free(decoder->keyframes[i].previous);
+    }
+    free(decoder->keyframes);
+    memset(decoder, 0, sizeof(*decoder));
+}
+
+
+// ============================================================================
+// Frame Source
+// ============================================================================
+
+int gif_source_open(gif_source_t* source, const media_file_t* file, size_t memory_cap) {
+    memset(source, 0, sizeof(*source));
+    if (!gif_decoder_open(&source->decoder, file)) {
+        return 0;
+    }
+
+    gif_decoder_t* decoder = &source->decoder;
+    size_t canvas_bytes = (size_t) decoder->width * (size_t) decoder->height * GIF_CHANNELS * sizeof(pixel_t);
+    size_t slots = canvas_bytes ? memory_cap / canvas_bytes : 1;
+    if (slots < 1) slots = 1;
+    if (slots > (size_t) decoder->frame_count) slots = (size_t) decoder->frame_count;
+
+    source->window = calloc(slots, sizeof(*source->window));
+    if (!source->window) {
+        fprintf(stderr, "Error: Failed to allocate GIF frame window!\n");
+        gif_decoder_close(decoder);
+        return 0;
+    }
+    source->window_size = (int) slots;
+    source->memory_cap = memory_cap;
+    for (int i = 0; i < source->window_size; i++) {
+        source->window[i].frame = -1;
+    }
+    pthread_mutex_init(&source->window_lock, NULL);
+
+    printf("Loaded GIF: %d frames, %dx%d, %d channels\n",
+           decoder->frame_count, decoder->width, decoder->height, GIF_CHANNELS);
+    return 1;
+}
+
+
+// Turns on the decoder's seek index. Its snapshots share the memory cap with
+// the window: each gets half, and the window keeps at least one slot.
+// Returns 0 if out of memory.
+int gif_source_enable_seek(gif_source_t* source) {
+    gif_decoder_t* decoder = &source->decoder;
+    size_t canvas_bytes = (size_t) decoder->width * (size_t) decoder->height * GIF_CHANNELS * sizeof(pixel_t);
+    size_t slots = canvas_bytes ? source->memory_cap / 2 / canvas_bytes : 1;
+    if (slots < 1) slots = 1;
+    while (source->window_size > (int) slots) {
+        gif_window_slot_t* slot = &source->window[--source->window_size];
+        free_image(&slot->canvas);
+        slot->frame = -1;
+    }
+    return gif_decoder_enable_seek(decoder, source->memory_cap / 2);
+}
+
+
+// Copies a composed canvas into the empty or least recently used slot
+static gif_window_slot_t* store_canvas(gif_source_t* source, int frame, const unsigned char* rgba) {
+    gif_window_slot_t* slot = &source->window[0];
+    for (int i = 0; i < source->window_size; i++) {
+        gif_window_slot_t* candidate = &source->window[i];
+        if (candidate->frame < 0) {
+            slot = candidate;
+            break;
+        }
+        if (candidate->last_used < slot->last_used) {
+            slot = candidate;
+        }
+    }
+
+    image_t* canvas = &slot->canvas;
+    size_t samples = (size_t) source->decoder.width * (size_t) source->decoder.height * GIF_CHANNELS;
+    if (!canvas->data) {
+        canvas->data = malloc(samples * sizeof(*canvas->data));
+        source->heap_allocations++;
+        if (!canvas->data) {
+            fprintf(stderr, "Error: Failed to allocate GIF frame!\n");
+            return NULL;
+        }
+        canvas->width = (size_t) source->decoder.width;
+        canvas->height = (size_t) source->decoder.height;
+        canvas->channels = GIF_CHANNELS;
+    }
+    for (size_t i = 0; i < samples; i++) {
+        canvas->data[i] = PIXEL_FROM_BYTE(rgba[i]);
+    }
+
+    pthread_mutex_lock(&source->window_lock);
+    slot->frame = frame;
+    pthread_mutex_unlock(&source->window_lock);
+    slot->last_used = source->clock;
+    return slot;
+}
+
+
+// Returns frame `index`, composed, or NULL past the end or on a corrupt
+// frame. The image stays valid until the next call. If the frame has to be
+// composed and `decoded` holds its raster, that is used instead of decoding.
+const image_t* gif_source_frame(gif_source_t* source, int index, const gif_raster_t* decoded) {
+    gif_decoder_t* decoder = &source->decoder;
+    if (index < 0 || index >= decoder->playable_frames) {
+        return NULL;
+    }
+
+    source->clock++;
+    for (int i = 0; i < source->window_size; i++) {
+        if (source->window[i].frame == index) {
+            source->window[i].last_used = source->clock;
+            return &source->window[i].canvas;
+        }
+    }
+
+    // Composition is sequential: earlier frames are reached from the start
+    // or the nearest keyframe
+    gif_decoder_seek(decoder, index);
+
+    gif_window_slot_t* slot = NULL;
+    while (decoder->next_frame <= index) {
+        const unsigned char* rgba = gif_decoder_next(decoder, decoded);
+        if (!rgba) return NULL;
+        source->decoded_frames++;
+        slot = store_canvas(source, decoder->next_frame - 1, rgba);
+        if (!slot) return NULL;
+    }
+    return &slot->canvas;
+}
+
+
+// Whether frame `index` is in the window. Safe to call while another thread
+// requests frames; the answer may be stale by the time the frame is asked for.
+int gif_source_holds(gif_source_t* source, int index) {
+    int held = 0;
+    pthread_mutex_lock(&source->window_lock);
+    for (int i = 0; i < source->window_size && !held; i++) {
+        held = source->window[i].frame == index;
+    }
+    pthread_mutex_unlock(&source->window_lock);
+    return held;
+}
+
+
+// Empties the window, keeping its buffers, and rewinds the decoder
+void gif_source_flush(gif_source_t* source) {
+    pthread_mutex_lock(&source->window_lock);
+    for (int i = 0; i < source->window_size; i++) {
+        source->window[i].frame = -1;
+    }
+    pthread_mutex_unlock(&source->window_lock);
+    gif_decoder_rewind(&source->decoder);
+}
+
+
+void gif_source_close(gif_source_t* source) {
+    for (int i = 0; i < source->window_size; i++) {
+        free_image(&source->window[i].canvas);
+    }
+    free(source->window);
+    pthread_mutex_destroy(&source->window_lock);
+    gif_decoder_close(&source->decoder);
+    memset(source, 0, sizeof(*source));
+}
@@ -25,27 +25,33 @@
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 #define STB_IMAGE_IMPLEMENTATION
+// Input always comes through media_file_t, so stb's stdio loaders are unused
+#define STBI_NO_STDIO
 #include "../include/stb_image.h"
 #pragma GCC diagnostic pop
 
 #include "../include/image.h"
+#include "../include/convolve.h"
+#include <math.h>
 #include <string.h>
+#include <limits.h>
+#include <stddef.h>
 
-// For GIF animation and timing
-#include <unistd.h>
-#include <sys/time.h>
-#include <time.h>
 
-
-image_t load_image(const char* file_path) {
+// Decodes a still image straight from the mapped file
+image_t load_image(const media_file_t* file) {
     int width, height, channels;
-    unsigned char* raw_data = stbi_load(file_path, &width, &height, &channels, 0);
+    unsigned char* raw_data = NULL;
+    if (file->size <= INT_MAX) {
+        raw_data = stbi_load_from_memory(file->data, (int) file->size, &width, &height, &channels, 0);
+    }
 
     if (!raw_data) {
-        fprintf(stderr, "Error: Failed to load image '%s': %s!\n", file_path, stbi_failure_reason());
+        fprintf(stderr, "Error: Failed to load image '%s': %s!\n", file->path, stbi_failure_reason());
         return (image_t) {0}; // Return empty image on failure
     }
 
+#ifdef ASCIIVIEW_DOUBLE_PIXELS
     // Convert to [0., 1.]
     size_t total_size = (size_t) width * height * channels;
     double* data = calloc(total_size, sizeof(*data));
@@ -56,10 +62,15 @@ image_t load_image(const char* file_path) {
     }
 
     for (size_t i = 0; i < total_size; i++) {
-        data[i] = raw_data[i] / 255.0;
+        data[i] = PIXEL_FROM_BYTE(raw_data[i]);
     }
 
     stbi_image_free(raw_data);
+#else
+    // 8-bit pixels are used as decoded; stb allocates with malloc so the
+    // buffer can be released through free_image()
+    pixel_t* data = raw_data;
+#endif
 
     return (image_t) {
         .width = (size_t) width,
@@ -80,14 +91,14 @@ void free_image(image_t* image) {
 
 
 // Gets pointer to pixel data at index (x, y)
-double* get_pixel(image_t* image, size_t x, size_t y) {
+pixel_t* get_pixel(image_t* image, size_t x, size_t y) {
     return &image->data[(y * image->width + x) * image->channels];
 }
 
 
 // Sets pixel channel values to those of new_pixel
-void set_pixel(image_t* image, size_t x, size_t y, const double* new_pixel) {
-    double* pixel = get_pixel(image, x, y);
+void set_pixel(image_t* image, size_t x, size_t y, const pixel_t* new_pixel) {
+    pixel_t* pixel = get_pixel(image, x, y);
     for (size_t c = 0; c < image->channels; c++) {
         pixel[c] = new_pixel[c];
     }
@@ -95,40 +106,39 @@ void set_pixel(image_t* image, size_t x, size_t y, const double* new_pixel) {
 
 
 // Gets average pixel value in rectangular region; writes to `average`
-void get_average(image_t* image, double* average, size_t x1, size_t x2, size_t y1, size_t y2) {
-    // Set average to zero
-    for (size_t c = 0; c < image->channels; c++) {
-        average[c] = 0.0;
-    }
+void get_average(image_t* image, pixel_t* average, size_t x1, size_t x2, size_t y1, size_t y2) {
+    pixel_sum_t total[4] = {0};
 
     // Get total
     for (size_t y = y1; y < y2; y++) {
         for (size_t x = x1; x < x2; x++) {
-            double* pixel = get_pixel(image, x, y);
+            pixel_t* pixel = get_pixel(image, x, y);
             for (size_t c = 0; c < image->channels; c++) {
-                average[c] += pixel[c];
+                total[c] += pixel[c];
             }
         }
     }
 
-    // Divide by number of pixels in region
-    double n_pixels = (double) (x2 - x1) * (y2 - y1);
+    // Divide by number of pixels in region (rounded for 8-bit pixels)
+    size_t n_pixels = (x2 - x1) * (y2 - y1);
     for (size_t c = 0; c < image->channels; c++) {
-        average[c] /= n_pixels;
+        average[c] = PIXEL_FROM_SUM(total[c], n_pixels);
     }
 }
 
 
-image_t make_resized(image_t* original, size_t max_width, size_t max_height, double character_ratio) {
+// Computes output size for a source image fitted into max_width x max_height
+// characters while preserving its aspect ratio
+void get_resized_dimensions(size_t source_width, size_t source_height, size_t max_width, size_t max_height,
+                            double character_ratio, size_t* out_width, size_t* out_height) {
     size_t width, height;
-    size_t channels = original->channels;
 
     // CRITICAL: Aspect ratio correction untuk mencegah gepeng
     // character_ratio = 2.0 karena karakter terminal tingginya 2x lebarnya
     // Rumus: aspect_corrected = (img_width / img_height) / character_ratio
     
-    double img_width = (double)original->width;
-    double img_height = (double)original->height;
+    double img_width = (double)source_width;
+    double img_height = (double)source_height;
     
     // Enforce minimum constraints FIRST (before scaling calculation)
     if (max_width < 10) max_width = 10;
@@ -176,45 +186,192 @@ image_t make_resized(image_t* original, size_t max_width, size_t max_height, dou
         fprintf(stderr, "⚠️  Aspect ratio deviation: %.1f%% (target: <3%%)\n", deviation * 100.0);
     }
 
-    double* data = calloc(width * height * channels, sizeof(*data));
-    if (!data) {
+    *out_width = width;
+    *out_height = height;
+}
+
+
+// Gets the source span [start, end) averaged into output index `index`
+void get_resize_span(size_t index, size_t out_size, size_t in_size, size_t* start, size_t* end) {
+    size_t s1 = (index * in_size) / out_size;
+    size_t s2 = ((index + 1) * in_size) / out_size;
+    if (s2 > in_size) s2 = in_size;
+    if (s1 >= s2) s2 = s1 + 1;
+
+    *start = s1;
+    *end = s2;
+}
+
+
+// Adds source row y to a summed-area-table row over columns [x0, x1):
+// sat[(x - x0 + 1) * channels + c] becomes the sum of channel c over the
+// rows added so far and columns [x0, x]
+static void advance_sat_row(const image_t* image, size_t y, size_t x0, size_t x1, pixel_sum_t* sat) {
+    size_t channels = image->channels;
+    const pixel_t* row = image->data + (y * image->width + x0) * channels;
+    pixel_sum_t running[4] = {0};
+
+    for (size_t x = 0; x < x1 - x0; x++) {
+        pixel_sum_t* out = sat + (x + 1) * channels;
+        for (size_t c = 0; c < channels; c++) {
+            running[c] += row[x * channels + c];
+            out[c] += running[c];
+        }
+    }
+}
+
+
+// Temporary buffers for the resize and enhancement filters
+static void* scratch_alloc(arena_t* scratch, size_t size) {
+    return scratch ? arena_alloc(scratch, size) : malloc(size);
+}
+
+static void scratch_release(arena_t* scratch, void* ptr) {
+    if (!scratch) free(ptr);
+}
+
+
+// Box-average resize over a summed-area table. Only the table rows at span
+// boundaries are kept, so each cell is four lookups per channel and the cost
+// is one pass over the source whatever the output size.
+image_t make_resized(image_t* original, size_t max_width, size_t max_height, double character_ratio) {
+    size_t width, height;
+    get_resized_dimensions(original->width, original->height, max_width, max_height,
+                           character_ratio, &width, &height);
+    return make_resized_region(original, width, height, 0, 0, width, height);
+}
+
+
+// Resizes only the cells [left, right) x [top, bottom) of a width x height
+// resize into `data`, which holds the region's samples, reading just the
+// source spans they cover. The table starts at the region's corner; box sums
+// of 8-bit pixels are exact integers, so the cells equal those of the full
+// resize. Temporaries come from `scratch` when given, otherwise from the
+// heap. Returns 0 if out of memory.
+int resize_region_into(const image_t* original, size_t width, size_t height,
+                       size_t left, size_t top, size_t right, size_t bottom, pixel_t* data, arena_t* scratch) {
+    size_t channels = original->channels;
+    size_t region_width = right - left;
+    size_t region_height = bottom - top;
+
+    size_t x_start = 0, x_end = 0, unused;
+    if (region_width > 0) {
+        get_resize_span(left, width, original->width, &x_start, &unused);
+        get_resize_span(right - 1, width, original->width, &unused, &x_end);
+    }
+
+    size_t sat_length = (x_end - x_start + 1) * channels;
+    pixel_sum_t* sat_top = scratch_alloc(scratch, 2 * sat_length * sizeof(*sat_top));
+    size_t* column_spans = scratch_alloc(scratch, (2 * region_width + 1) * sizeof(*column_spans));
+    if (!sat_top || !column_spans) {
         fprintf(stderr, "Error: Failed to allocate memory for resized image!\n");
-        return (image_t) {0};
+        scratch_release(scratch, sat_top);
+        scratch_release(scratch, column_spans);
+        return 0;
+    }
+    memset(sat_top, 0, 2 * sat_length * sizeof(*sat_top));
+    pixel_sum_t* sat_bottom = sat_top + sat_length;
+
+    // Column spans relative to the region's first source column
+    for (size_t i = 0; i < region_width; i++) {
+        get_resize_span(left + i, width, original->width, &column_spans[2 * i], &column_spans[2 * i + 1]);
+        column_spans[2 * i] -= x_start;
+        column_spans[2 * i + 1] -= x_start;
     }
 
-    // High-quality area averaging with improved sampling
-    for (size_t j = 0; j < height; j++) {
-        size_t y1 = (j * original->height) / height;
-        size_t y2 = ((j + 1) * original->height) / height;
-        if (y2 > original->height) y2 = original->height;
-        if (y1 >= y2) y2 = y1 + 1;
-        
-        for (size_t i = 0; i < width; i++) {
-            size_t x1 = (i * original->width) / width;
-            size_t x2 = ((i + 1) * original->width) / width;
-            if (x2 > original->width) x2 = original->width;
-            if (x1 >= x2) x2 = x1 + 1;
+    // sat_top holds the table at row y1 and sat_bottom at row y2 of the current span
+    size_t top_y = 0, bottom_y;
+    if (region_height > 0) {
+        get_resize_span(top, height, original->height, &top_y, &unused);
+    }
+    bottom_y = top_y;
+    for (size_t j = 0; j < region_height; j++) {
+        size_t y1, y2;
+        get_resize_span(top + j, height, original->height, &y1, &y2);
+
+        // Spans never move backwards, and a new y1 always equals the previous y2
+        if (y1 != top_y) {
+            memcpy(sat_top, sat_bottom, sat_length * sizeof(*sat_top));
+            top_y = y1;
+        }
+        for (; bottom_y < y2; bottom_y++) {
+            advance_sat_row(original, bottom_y, x_start, x_end, sat_bottom);
+        }
+
+        for (size_t i = 0; i < region_width; i++) {
+            size_t x1 = column_spans[2 * i], x2 = column_spans[2 * i + 1];
+            size_t n_pixels = (x2 - x1) * (y2 - y1);
+            pixel_t* average = &data[(i + j * region_width) * channels];
 
-            get_average(original, &data[(i + j * width) * channels], x1, x2, y1, y2);
+            for (size_t c = 0; c < channels; c++) {
+                pixel_sum_t total = (sat_bottom[x2 * channels + c] - sat_bottom[x1 * channels + c])
+                                  - (sat_top[x2 * channels + c] - sat_top[x1 * channels + c]);
+                average[c] = PIXEL_FROM_SUM(total, n_pixels);
+            }
         }
     }
 
+    scratch_release(scratch, sat_top);
+    scratch_release(scratch, column_spans);
+    return 1;
+}
+
+
+// Resizes the cells [left, right) x [top, bottom) of a width x height resize
+// into a new image
+image_t make_resized_region(const image_t* original, size_t width, size_t height,
+                            size_t left, size_t top, size_t right, size_t bottom) {
+    size_t samples = (right - left) * (bottom - top) * original->channels;
+    pixel_t* data = calloc(samples ? samples : 1, sizeof(*data));
+    if (!data) {
+        fprintf(stderr, "Error: Failed to allocate memory for resized image!\n");
+        return (image_t) {0};
+    }
+    if (!resize_region_into(original, width, height, left, top, right, bottom, data, NULL)) {
+        free(data);
+        return (image_t) {0};
+    }
+
     return (image_t) {
-        .width = width,
-        .height = height,
-        .channels = channels,
+        .width = right - left,
+        .height = bottom - top,
+        .channels = original->channels,
         .data = data
     };
 }
 
 
-// Create grayscale version of image. Note: Assumes original is at least RGB.
+// Copies `patch` into `image` with its top-left corner at (left, top)
+void paste_image(image_t* image, const image_t* patch, size_t left, size_t top) {
+    size_t row_length = patch->width * patch->channels;
+    for (size_t y = 0; y < patch->height; y++) {
+        memcpy(get_pixel(image, left, top + y), patch->data + y * row_length, row_length * sizeof(pixel_t));
+    }
+}
+
+
+// Luminance-weighted grayscale value of one pixel. Pixels with fewer than
+// three channels use their first channel.
+pixel_t pixel_grayscale(const pixel_t* pixel, size_t channels) {
+    if (channels < 3) {
+        return pixel[0];
+    }
+#ifdef ASCIIVIEW_DOUBLE_PIXELS
+    return 0.2126 * pixel[0] + 0.7152 * pixel[1] + 0.0722 * pixel[2];
+#else
+    // BT.709 weights in Q8: 54 + 183 + 19 = 256
+    return (pixel_t) ((54u * pixel[0] + 183u * pixel[1] + 19u * pixel[2] + 128u) >> 8);
+#endif
+}
+
+
+// Create grayscale version of image.
 image_t make_grayscale(image_t* original) {
     size_t width = original->width;
     size_t height = original->height;
     size_t channels = 1;
 
-    double* data = calloc(width * height, sizeof(*data));
+    pixel_t* data = calloc(width * height, sizeof(*data));
     if (!data) {
         fprintf(stderr, "Error: Failed to allocate memory for resized image!\n");
         return (image_t) {0};
@@ -229,10 +386,7 @@ image_t make_grayscale(image_t* original) {
 
     for (size_t y = 0; y < height; y++) {
         for (size_t x = 0; x < width; x++) {
-            double* pixel = get_pixel(original, x, y);
-
-            // Luminance-weighted graycsale. Could be a callback...
-            double grayscale = 0.2126 * pixel[0] + 0.7152 * pixel[1] + 0.0722 * pixel[2];
+            pixel_t grayscale = pixel_grayscale(get_pixel(original, x, y), original->channels);
 
             set_pixel(&new, x, y, &grayscale);
         }
@@ -242,8 +396,45 @@ image_t make_grayscale(image_t* original) {
 }
 
 
-double calculate_convolution_value(image_t* image, double* kernel, size_t x, size_t y, size_t c) {
-    double result = 0.0;
+// Convolution arithmetic. 8-bit images use Q12 fixed-point coefficients
+// with a 32-bit accumulator; the reference build convolves in doubles.
+#ifdef ASCIIVIEW_DOUBLE_PIXELS
+typedef double conv_t;
+#define CONV_COEFF(k) (k)
+#define CONV_TO_UNIT(acc) (acc)
+#else
+typedef int32_t conv_t;
+#define CONV_SHIFT 12
+#define CONV_COEFF(k) ((conv_t) lround((k) * (1 << CONV_SHIFT)))
+#define CONV_TO_UNIT(acc) ((acc) * (1.0 / (255.0 * (1 << CONV_SHIFT))))
+#endif
+
+
+// Converts a 3x3 kernel to convolution coefficients
+static void prepare_kernel(const double* kernel, conv_t* out) {
+    for (int i = 0; i < 9; i++) {
+        out[i] = CONV_COEFF(kernel[i]);
+    }
+}
+
+
+// Rounds and clamps a convolution result to the pixel range
+static pixel_t conv_to_pixel(conv_t acc) {
+#ifdef ASCIIVIEW_DOUBLE_PIXELS
+    if (acc < 0.0) return 0.0;
+    if (acc > 1.0) return 1.0;
+    return acc;
+#else
+    acc = (acc + (1 << (CONV_SHIFT - 1))) >> CONV_SHIFT;
+    if (acc < 0) return 0;
+    if (acc > PIXEL_MAX) return PIXEL_MAX;
+    return (pixel_t) acc;
+#endif
+}
+
+
+conv_t calculate_convolution_value(image_t* image, const conv_t* kernel, size_t x, size_t y, size_t c) {
+    conv_t result = 0;
 
     for (int j = -1; j < 2; j++) {
         for (int i = -1; i < 2; i++) {
@@ -258,16 +449,45 @@ double calculate_convolution_value(image_t* image, double* kernel, size_t x, siz
 }
 
 
+// Convolves the interior pixels of row y (1 <= y < height - 1), writing the
+// accumulators of samples [channels, (width - 1) * channels) of `acc`.
+// 8-bit images go through the vectorized engine in convolve.c.
+static void convolve_image_row(const image_t* image, size_t y, const conv_t* kernel, conv_t* acc) {
+#ifdef ASCIIVIEW_DOUBLE_PIXELS
+    for (size_t x = 1; x + 1 < image->width; x++) {
+        for (size_t c = 0; c < image->channels; c++) {
+            acc[x * image->channels + c] = calculate_convolution_value((image_t*) image, kernel, x, y, c);
+        }
+    }
+#else
+    size_t row_length = image->width * image->channels;
+    const pixel_t* row = image->data + y * row_length;
+    convolve_row_q12(row - row_length, row, row + row_length, acc, image->width, image->channels, kernel);
+#endif
+}
+
+
+
 // Calculates convolution with 3x3 kernel. Ignores edges.
 void get_convolution(image_t* image, double* kernel, double* out) {
-    for (size_t y = 1; y < image->height - 1; y++) {
-        for (size_t x = 1; x < image->width - 1; x++) {
-            for (size_t c = 0; c < image->channels; c++) {
-                size_t image_index = c + (x + y * image->width) * image->channels;
-                out[image_index] = calculate_convolution_value(image, kernel, x, y, c);
-            }
+    conv_t coeffs[9];
+    prepare_kernel(kernel, coeffs);
+
+    size_t row_length = image->width * image->channels;
+    conv_t* acc = malloc(row_length * sizeof(*acc));
+    if (!acc) {
+        fprintf(stderr, "Error: Failed to allocate memory for convolution!\n");
+        return;
+    }
+
+    for (size_t y = 1; y + 1 < image->height; y++) {
+        convolve_image_row(image, y, coeffs, acc);
+        for (size_t i = image->channels; i + image->channels < row_length; i++) {
+            out[y * row_length + i] = CONV_TO_UNIT(acc[i]);
         }
     }
+
+    free(acc);
 }
 
 
@@ -282,7 +502,7 @@ void get_sobel(image_t* image, double* out_x, double* out_y) {
 
 
 // Sharpening filter - enhances edges and details
-void sharpen_image(image_t* image, double strength) {
+void sharpen_image(image_t* image, double strength, arena_t* scratch) {
     if (!image || !image->data || strength <= 0.0) return;
     
     // Sharpening kernel
@@ -291,68 +511,206 @@ void sharpen_image(image_t* image, double strength) {
         -strength, 1.0 + 4.0 * strength, -strength,
         0.0, -strength, 0.0
     };
+    conv_t coeffs[9];
+    prepare_kernel(kernel, coeffs);
     
-    double* temp = calloc(image->width * image->height * image->channels, sizeof(*temp));
-    if (!temp) {
+    size_t row_length = image->width * image->channels;
+    pixel_t* temp = scratch_alloc(scratch, row_length * image->height * sizeof(*temp));
+    conv_t* acc = scratch_alloc(scratch, row_length * sizeof(*acc));
+    if (!temp || !acc) {
         fprintf(stderr, "Error: Failed to allocate memory for sharpening!\n");
+        scratch_release(scratch, temp);
+        scratch_release(scratch, acc);
         return;
     }
     
     // Copy original data
-    memcpy(temp, image->data, image->width * image->height * image->channels * sizeof(*temp));
+    memcpy(temp, image->data, row_length * image->height * sizeof(*temp));
     
     // Apply sharpening (skip edges)
-    for (size_t y = 1; y < image->height - 1; y++) {
-        for (size_t x = 1; x < image->width - 1; x++) {
-            for (size_t c = 0; c < image->channels; c++) {
-                double value = calculate_convolution_value(image, kernel, x, y, c);
-                
-                // Clamp value
-                if (value < 0.0) value = 0.0;
-                if (value > 1.0) value = 1.0;
-                
-                temp[c + (x + y * image->width) * image->channels] = value;
-            }
+    for (size_t y = 1; y + 1 < image->height; y++) {
+        convolve_image_row(image, y, coeffs, acc);
+        for (size_t i = image->channels; i + image->channels < row_length; i++) {
+            // Rounded and clamped to the pixel range
+            temp[y * row_length + i] = conv_to_pixel(acc[i]);
         }
     }
     
     // Copy back
-    memcpy(image->data, temp, image->width * image->height * image->channels * sizeof(*temp));
-    free(temp);
+    memcpy(image->data, temp, row_length * image->height * sizeof(*temp));
+    scratch_release(scratch, temp);
+    scratch_release(scratch, acc);
+}
+
+
+// Box radii for a three-pass box blur approximating a Gaussian with the
+// given radius (sigma). Box widths are odd and chosen so that the summed
+// variance of the three passes matches sigma^2.
+void get_box_blur_radii(double sigma, size_t radii[3]) {
+    const int passes = 3;
+    double ideal_width = sqrt(12.0 * sigma * sigma / passes + 1.0);
+    int lower = (int) floor(ideal_width);
+    if (lower % 2 == 0) lower--;
+    if (lower < 1) lower = 1;
+    int upper = lower + 2;
+
+    double ideal_lower = (12.0 * sigma * sigma - passes * lower * lower - 4.0 * passes * lower - 3.0 * passes)
+                       / (-4.0 * lower - 4.0);
+    int lower_passes = (int) lround(ideal_lower);
+
+    for (int i = 0; i < passes; i++) {
+        radii[i] = (size_t) ((i < lower_passes ? lower : upper) - 1) / 2;
+    }
+}
+
+
+// Clamps a window index to [0, count - 1]
+static size_t clamp_index(ptrdiff_t index, size_t count) {
+    if (index < 0) return 0;
+    if ((size_t) index >= count) return count - 1;
+    return (size_t) index;
+}
+
+
+// Horizontal box filter with a sliding sum, clamping at the edges
+static void box_blur_rows(const pixel_t* src, pixel_t* dst, size_t width, size_t height, size_t channels,
+                          size_t radius) {
+    size_t window = 2 * radius + 1;
+    for (size_t y = 0; y < height; y++) {
+        const pixel_t* row = src + y * width * channels;
+        pixel_t* out = dst + y * width * channels;
+
+        for (size_t c = 0; c < channels; c++) {
+            pixel_sum_t sum = 0;
+            for (ptrdiff_t k = -(ptrdiff_t) radius; k <= (ptrdiff_t) radius; k++) {
+                sum += row[clamp_index(k, width) * channels + c];
+            }
+            for (size_t x = 0; x < width; x++) {
+                out[x * channels + c] = PIXEL_FROM_SUM(sum, window);
+                sum += row[clamp_index((ptrdiff_t) (x + radius + 1), width) * channels + c];
+                sum -= row[clamp_index((ptrdiff_t) x - (ptrdiff_t) radius, width) * channels + c];
+            }
+        }
+    }
+}
+
+
+// Vertical box filter. Keeps one running sum per column so rows are read
+// sequentially instead of walking down columns.
+static void box_blur_columns(const pixel_t* src, pixel_t* dst, size_t width, size_t height, size_t channels,
+                             size_t radius, pixel_sum_t* sums) {
+    size_t window = 2 * radius + 1;
+    size_t row_length = width * channels;
+
+    memset(sums, 0, row_length * sizeof(*sums));
+    for (ptrdiff_t k = -(ptrdiff_t) radius; k <= (ptrdiff_t) radius; k++) {
+        const pixel_t* row = src + clamp_index(k, height) * row_length;
+        for (size_t i = 0; i < row_length; i++) {
+            sums[i] += row[i];
+        }
+    }
+
+    for (size_t y = 0; y < height; y++) {
+        const pixel_t* entering = src + clamp_index((ptrdiff_t) (y + radius + 1), height) * row_length;
+        const pixel_t* leaving = src + clamp_index((ptrdiff_t) y - (ptrdiff_t) radius, height) * row_length;
+        pixel_t* out = dst + y * row_length;
+        for (size_t i = 0; i < row_length; i++) {
+            out[i] = PIXEL_FROM_SUM(sums[i], window);
+            sums[i] += entering[i];
+            sums[i] -= leaving[i];
+        }
+    }
+}
+
+
+// Gaussian blur approximated by three box passes per axis. Cost per pixel
+// does not depend on the radius. Returns 0 if scratch memory ran out.
+static int box_blur(const image_t* image, pixel_t* blurred, double radius, arena_t* scratch) {
+    size_t row_length = image->width * image->channels;
+    pixel_t* temp = scratch_alloc(scratch, row_length * image->height * sizeof(*temp));
+    pixel_sum_t* sums = scratch_alloc(scratch, row_length * sizeof(*sums));
+    if (!temp || !sums) {
+        scratch_release(scratch, temp);
+        scratch_release(scratch, sums);
+        return 0;
+    }
+
+    size_t radii[3];
+    get_box_blur_radii(radius, radii);
+
+    const pixel_t* src = image->data;
+    for (int pass = 0; pass < 3; pass++) {
+        box_blur_rows(src, temp, image->width, image->height, image->channels, radii[pass]);
+        box_blur_columns(temp, blurred, image->width, image->height, image->channels, radii[pass], sums);
+        src = blurred;
+    }
+
+    scratch_release(scratch, temp);
+    scratch_release(scratch, sums);
+    return 1;
+}
+
+
+// How far unsharp_mask() reaches: each output pixel depends only on input
+// pixels within this many pixels of it in either axis
+size_t unsharp_mask_halo(double radius) {
+    if (radius <= 1.0) return 1;
+    size_t radii[3];
+    get_box_blur_radii(radius, radii);
+    return radii[0] + radii[1] + radii[2];
 }
 
 
 // Unsharp mask - professional sharpening technique
-void unsharp_mask(image_t* image, double amount, double radius) {
-    if (!image || !image->data || amount <= 0.0) return;
+// Radius (Gaussian sigma, in pixels) up to 1.0 uses the fixed 3x3 kernel;
+// larger radii use the separable box-blur approximation.
+void unsharp_mask(image_t* image, double amount, double radius, arena_t* scratch) {
+    if (!image || !image->data || !image->width || !image->height || amount <= 0.0) return;
     
-    // Suppress unused parameter warning (radius currently fixed at 1.0)
-    (void)radius;
-    
-    // Simple gaussian blur kernel (approximation for radius ~1.0)
-    double blur_kernel[] = {
-        1.0/16, 2.0/16, 1.0/16,
-        2.0/16, 4.0/16, 2.0/16,
-        1.0/16, 2.0/16, 1.0/16
-    };
-    
-    double* blurred = calloc(image->width * image->height * image->channels, sizeof(*blurred));
+    size_t blurred_size = image->width * image->height * image->channels * sizeof(pixel_t);
+    pixel_t* blurred = scratch_alloc(scratch, blurred_size);
     if (!blurred) {
         fprintf(stderr, "Error: Failed to allocate memory for unsharp mask!\n");
         return;
     }
     
-    // Apply gaussian blur
-    for (size_t y = 1; y < image->height - 1; y++) {
-        for (size_t x = 1; x < image->width - 1; x++) {
-            for (size_t c = 0; c < image->channels; c++) {
-                blurred[c + (x + y * image->width) * image->channels] = 
-                    calculate_convolution_value(image, blur_kernel, x, y, c);
+    if (radius > 1.0) {
+        if (!box_blur(image, blurred, radius, scratch)) {
+            fprintf(stderr, "Error: Failed to allocate memory for unsharp mask!\n");
+            scratch_release(scratch, blurred);
+            return;
+        }
+    } else {
+        // Simple gaussian blur kernel (approximation for radius ~1.0)
+        double blur_kernel[] = {
+            1.0/16, 2.0/16, 1.0/16,
+            2.0/16, 4.0/16, 2.0/16,
+            1.0/16, 2.0/16, 1.0/16
+        };
+        conv_t coeffs[9];
+        prepare_kernel(blur_kernel, coeffs);
+        
+        size_t row_length = image->width * image->channels;
+        conv_t* acc = scratch_alloc(scratch, row_length * sizeof(*acc));
+        if (!acc) {
+            fprintf(stderr, "Error: Failed to allocate memory for unsharp mask!\n");
+            scratch_release(scratch, blurred);
+            return;
+        }
+        memset(blurred, 0, blurred_size);
+        
+        // Apply gaussian blur
+        for (size_t y = 1; y + 1 < image->height; y++) {
+            convolve_image_row(image, y, coeffs, acc);
+            for (size_t i = image->channels; i + image->channels < row_length; i++) {
+                blurred[y * row_length + i] = conv_to_pixel(acc[i]);
             }
         }
+        scratch_release(scratch, acc);
     }
     
     // Unsharp mask formula: sharpened = original + amount * (original - blurred)
+#ifdef ASCIIVIEW_DOUBLE_PIXELS
     for (size_t i = 0; i < image->width * image->height * image->channels; i++) {
         double sharp = image->data[i] + amount * (image->data[i] - blurred[i]);
         
@@ -362,133 +720,21 @@ void unsharp_mask(image_t* image, double amount, double radius) {
         
         image->data[i] = sharp;
     }
-    
-    free(blurred);
-}
-
-
-// Check if file is a GIF
-int is_gif_file(const char* file_path) {
-    FILE* f = fopen(file_path, "rb");
-    if (!f) return 0;
-    
-    unsigned char header[6];
-    size_t read = fread(header, 1, 6, f);
-    fclose(f);
-    
-    if (read != 6) return 0;
-    
-    // Check for GIF87a or GIF89a signature
-    return (header[0] == 'G' && header[1] == 'I' && header[2] == 'F' &&
-            header[3] == '8' && (header[4] == '7' || header[4] == '9') &&
-            header[5] == 'a');
-}
-
-
-// Load animated GIF using stb_image GIF API
-gif_animation_t load_gif_animation(const char* file_path) {
-    gif_animation_t anim = {0};
-    
-    // Read entire file into memory
-    FILE* f = fopen(file_path, "rb");
-    if (!f) {
-        fprintf(stderr, "Error: Cannot open file '%s'\n", file_path);
-        return anim;
-    }
-    
-    fseek(f, 0, SEEK_END);
-    long file_size = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    
-    unsigned char* file_data = malloc(file_size);
-    if (!file_data) {
-        fprintf(stderr, "Error: Failed to allocate memory for GIF data\n");
-        fclose(f);
-        return anim;
-    }
-    
-    fread(file_data, 1, file_size, f);
-    fclose(f);
-    
-    // Load GIF with all frames using stbi_load_gif_from_memory
-    int* delays_centiseconds = NULL;
-    int width = 0, height = 0, frame_count = 0, channels = 0;
-    
-    // Load all GIF frames at once
-    stbi_uc* raw_frames = stbi_load_gif_from_memory(
-        file_data, file_size,
-        &delays_centiseconds,
-        &width, &height, &frame_count, &channels,
-        0  // 0 = use image's channel count
-    );
-    
-    free(file_data);
-    
-    if (!raw_frames || frame_count == 0) {
-        fprintf(stderr, "Error: Failed to load GIF animation: %s\n", stbi_failure_reason());
-        if (delays_centiseconds) free(delays_centiseconds);
-        return anim;
-    }
-    
-    printf("Loaded GIF: %d frames, %dx%d, %d channels\n", frame_count, width, height, channels);
-    
-    // Allocate arrays for frames
-    anim.frame_count = frame_count;
-    anim.frames = calloc(frame_count, sizeof(image_t));
-    anim.delays = calloc(frame_count, sizeof(int));
-    
-    if (!anim.frames || !anim.delays) {
-        fprintf(stderr, "Error: Failed to allocate memory for frames\n");
-        stbi_image_free(raw_frames);
-        free(delays_centiseconds);
-        return anim;
-    }
-    
-    // Copy delays
-    for (int i = 0; i < frame_count; i++) {
-        anim.delays[i] = delays_centiseconds[i];
-    }
-    free(delays_centiseconds);
-    
-    // Convert each frame from raw bytes to our image_t format
-    size_t frame_size = (size_t)width * height * channels;
-    for (int i = 0; i < frame_count; i++) {
-        double* data = calloc(frame_size, sizeof(*data));
-        if (!data) {
-            fprintf(stderr, "Error: Failed to allocate frame %d\n", i);
-            continue;
-        }
+#else
+    // Amount in Q8 fixed point
+    int32_t amount_q8 = (int32_t) lround(amount * 256.0);
+    for (size_t i = 0; i < image->width * image->height * image->channels; i++) {
+        int32_t detail = (int32_t) image->data[i] - (int32_t) blurred[i];
+        int32_t sharp = image->data[i] + ((amount_q8 * detail + 128) >> 8);
         
-        // Convert frame data from 0-255 to 0.0-1.0
-        stbi_uc* frame_start = raw_frames + (i * frame_size);
-        for (size_t j = 0; j < frame_size; j++) {
-            data[j] = frame_start[j] / 255.0;
-        }
+        // Clamp
+        if (sharp < 0) sharp = 0;
+        if (sharp > PIXEL_MAX) sharp = PIXEL_MAX;
         
-        anim.frames[i].width = width;
-        anim.frames[i].height = height;
-        anim.frames[i].channels = channels;
-        anim.frames[i].data = data;
+        image->data[i] = (pixel_t) sharp;
     }
+#endif
     
-    stbi_image_free(raw_frames);
-    
-    return anim;
+    scratch_release(scratch, blurred);
 }
 
-
-// Free GIF animation
-void free_gif_animation(gif_animation_t* anim) {
-    if (!anim) return;
-    
-    for (int i = 0; i < anim->frame_count; i++) {
-        free_image(&anim->frames[i]);
-    }
-    
-    free(anim->frames);
-    free(anim->delays);
-    
-    anim->frames = NULL;
-    anim->delays = NULL;
-    anim->frame_count = 0;
-}
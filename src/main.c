@@ -26,8 +26,16 @@
 #include <stdlib.h>
 
 #include "../include/image.h"
+#include "../include/planar_image.h"
 #include "../include/print_image.h"
 #include "../include/argparse.h"
+#include "../include/convolve.h"
+
+
+// Half of --gif-memory holds decoded canvases, the other half the frame store
+static size_t gif_window_cap(const args_t* args) {
+    return (size_t) args->gif_memory_mb * 1024 * 1024 / 2;
+}
 
 
 int main(int argc, char* argv[]) {
@@ -42,13 +50,43 @@ int main(int argc, char* argv[]) {
         return 0;
     }
 
+    // Opens and maps the input once; the format is sniffed from its header
+    media_file_t file;
+    if (!media_file_open(&file, args.file_path))
+        return 1;
+
+    // Benchmark mode for animations: frame preparation scaling over workers
+    if (args.bench_mode && args.animate_gif && file.format == MEDIA_FORMAT_GIF) {
+        gif_source_t source;
+        int opened = gif_source_open(&source, &file, gif_window_cap(&args));
+        if (opened) {
+            frame_pipeline_run_bench(&source, &args, args.threads);
+            gif_source_close(&source);
+        }
+        media_file_close(&file);
+        return opened ? 0 : 1;
+    }
+
+    // Benchmark mode: time the convolution variants on the full-size image
+    if (args.bench_mode) {
+        image_t original = load_image(&file);
+        media_file_close(&file);
+        if (!original.data)
+            return 1;
+        convolve_run_bench(&original, 5);
+        free_image(&original);
+        return 0;
+    }
+
     // Check if file is GIF and animate flag is set
-    if (is_gif_file(args.file_path) && args.animate_gif) {
-        // Load and play animated GIF
-        gif_animation_t anim = load_gif_animation(args.file_path);
-        if (anim.frame_count > 0) {
-            play_gif_animation(&anim, &args);
-            free_gif_animation(&anim);
+    int animated = 0;
+    if (file.format == MEDIA_FORMAT_GIF && args.animate_gif) {
+        // Decode frames on demand
+        gif_source_t source;
+        if (gif_source_open(&source, &file, gif_window_cap(&args))) {
+            play_gif_animation(&source, &args);
+            gif_source_close(&source);
+            animated = 1;
         } else {
             fprintf(stderr, "Warning: Could not load GIF animation, falling back to static image\n");
             // Fall through to static image loading
@@ -56,31 +94,46 @@ int main(int argc, char* argv[]) {
     }
     
     // If not animated or animation failed, load as static image
-    if (!args.animate_gif || !is_gif_file(args.file_path)) {
+    if (!animated) {
         // Loads image
-        image_t original = load_image(args.file_path);
+        image_t original = load_image(&file);
+        media_file_close(&file);
         if (!original.data)
             return 1;
 
-        // Apply sharpening if requested
+        image_t resized;
         if (args.sharpen_strength > 0.0) {
-            unsharp_mask(&original, args.sharpen_strength, 1.0);
+            // Sharpen the full-resolution original in the planar float format,
+            // a strip of rows at a time, resizing as the strips are done
+            size_t width, height;
+            get_resized_dimensions(original.width, original.height, args.max_width, args.max_height,
+                                   args.character_ratio, &width, &height);
+            planar_image_t planar_resized = make_planar_sharpened_resized(&original, width, height,
+                                                                          (float) args.sharpen_strength,
+                                                                          (float) args.sharpen_radius);
+            free_image(&original);
+
+            resized = make_interleaved(&planar_resized);
+            free_planar(&planar_resized);
+        } else {
+            // Resizes image
+            resized = make_resized(&original, args.max_width, args.max_height, args.character_ratio);
         }
-        
-        // Resizes image
-        image_t resized = make_resized(&original, args.max_width, args.max_height, args.character_ratio);
         if (!resized.data) {
             free_image(&original);
             return 1;
         }
         
         // Use new args-based print function for enhanced features
-        args_t print_args = args;
-        print_image(&resized, print_args.edge_threshold, print_args.use_retro_colors, print_args.use_braille, print_args.use_grayscale);
+        render_context_t ctx;
+        render_context_init(&ctx);
+        print_image_with_options(&ctx, &resized, &args);
+        render_context_free(&ctx);
         
         free_image(&original);
         free_image(&resized);
     }
+    media_file_close(&file);
     
     // Check if shutdown was requested during processing
     if (g_shutdown_requested) {
@@ -0,0 +1,139 @@
+/*
+ * ASCII Image Converter - Media File Input
+ *
+ * Copyright (c) 2025 danko12
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "../include/media_file.h"
+
+// Only the first few bytes are needed to tell the supported formats apart
+media_format_t media_probe_format(const unsigned char* data, size_t size) {
+    if (size >= 6 && !memcmp(data, "GIF8", 4) && (data[4] == '7' || data[4] == '9') && data[5] == 'a')
+        return MEDIA_FORMAT_GIF;
+    if (size >= 8 && !memcmp(data, "\x89PNG\r\n\x1a\n", 8))
+        return MEDIA_FORMAT_PNG;
+    if (size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF)
+        return MEDIA_FORMAT_JPEG;
+    if (size >= 2 && data[0] == 'B' && data[1] == 'M')
+        return MEDIA_FORMAT_BMP;
+    if (size >= 2 && data[0] == 'P' && (data[1] == '5' || data[1] == '6'))
+        return MEDIA_FORMAT_PNM;
+    return MEDIA_FORMAT_UNKNOWN;
+}
+
+
+// Fallback for inputs without a fixed size: read until EOF
+static int read_stream(media_file_t* file, int fd) {
+    size_t capacity = 64 * 1024, size = 0;
+    unsigned char* data = malloc(capacity);
+    if (!data) return 0;
+
+    for (;;) {
+        if (size == capacity) {
+            unsigned char* grown = realloc(data, capacity * 2);
+            if (!grown) {
+                free(data);
+                return 0;
+            }
+            data = grown;
+            capacity *= 2;
+        }
+        ssize_t result = read(fd, data + size, capacity - size);
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            free(data);
+            return 0;
+        }
+        if (result == 0) break;
+        size += (size_t) result;
+    }
+
+    file->data = data;
+    file->size = size;
+    return 1;
+}
+
+
+// Opens and maps a file. Returns 1 on success, 0 on failure (with an error printed).
+int media_file_open(media_file_t* file, const char* path) {
+    memset(file, 0, sizeof(*file));
+    file->path = path;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open file '%s': %s!\n", path, strerror(errno));
+        return 0;
+    }
+
+    struct stat info;
+    int ok = 0;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        // Decoders read the file front to back exactly once
+#ifdef POSIX_FADV_SEQUENTIAL
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        void* mapping = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            madvise(mapping, (size_t) info.st_size, MADV_SEQUENTIAL);
+            madvise(mapping, (size_t) info.st_size, MADV_WILLNEED);
+            file->data = mapping;
+            file->size = (size_t) info.st_size;
+            file->mapped = 1;
+            ok = 1;
+        }
+    }
+    if (!ok) {
+        ok = read_stream(file, fd);
+    }
+    close(fd);
+
+    if (!ok || file->size == 0) {
+        fprintf(stderr, "Error: Failed to read file '%s'!\n", path);
+        media_file_close(file);
+        return 0;
+    }
+
+    file->format = media_probe_format(file->data, file->size);
+    return 1;
+}
+
+
+void media_file_close(media_file_t* file) {
+    if (file->data) {
+        if (file->mapped) {
+            munmap((void*) file->data, file->size);
+        } else {
+            free((void*) file->data);
+        }
+    }
+    file->data = NULL;
+    file->size = 0;
+    file->mapped = 0;
+}
@@ -0,0 +1,559 @@
+/*
+ * ASCII Image Converter - Planar Float Image Processing
+ *
+ * Copyright (c) 2025 danko12
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+
+#include "../include/planar_image.h"
+#include "../include/convolve.h"
+
+#define FLOATS_PER_LINE (PLANAR_ALIGNMENT / sizeof(float))
+
+// Source rows make_planar_sharpened_resized() sharpens at a time, besides
+// the filter's reach above and below
+#define PLANAR_STRIP_ROWS 128
+
+
+static void* aligned_calloc(size_t size) {
+    void* ptr = NULL;
+    if (posix_memalign(&ptr, PLANAR_ALIGNMENT, size) != 0) {
+        return NULL;
+    }
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+
+static float clamp_unit(float value) {
+    if (value < 0.0f) return 0.0f;
+    if (value > 1.0f) return 1.0f;
+    return value;
+}
+
+
+// Lays out planes over `storage`, which must hold planar_storage_size() bytes
+static planar_image_t planar_layout(float* storage, size_t width, size_t height, size_t channels) {
+    planar_image_t image = {
+        .width = width,
+        .height = height,
+        .channels = channels,
+        .stride = (width + FLOATS_PER_LINE - 1) / FLOATS_PER_LINE * FLOATS_PER_LINE,
+        .storage = storage
+    };
+    for (size_t c = 0; c < channels; c++) {
+        image.planes[c] = storage + c * image.stride * height;
+    }
+
+    return image;
+}
+
+
+static size_t planar_storage_size(size_t width, size_t height, size_t channels) {
+    // Pad rows to a whole number of cache lines
+    size_t stride = (width + FLOATS_PER_LINE - 1) / FLOATS_PER_LINE * FLOATS_PER_LINE;
+    return stride * height * channels * sizeof(float);
+}
+
+
+static int valid_dimensions(size_t width, size_t height, size_t channels) {
+    if (channels == 0 || channels > PLANAR_MAX_CHANNELS || width == 0 || height == 0) {
+        fprintf(stderr, "Error: Invalid planar image dimensions!\n");
+        return 0;
+    }
+    return 1;
+}
+
+
+planar_image_t make_planar_blank(size_t width, size_t height, size_t channels) {
+    if (!valid_dimensions(width, height, channels)) {
+        return (planar_image_t) {0};
+    }
+
+    float* storage = aligned_calloc(planar_storage_size(width, height, channels));
+    if (!storage) {
+        fprintf(stderr, "Error: Failed to allocate memory for planar image!\n");
+        return (planar_image_t) {0};
+    }
+
+    return planar_layout(storage, width, height, channels);
+}
+
+
+// Zeroed planar image in arena memory; released by arena_reset, not free_planar
+planar_image_t make_planar_scratch(arena_t* scratch, size_t width, size_t height, size_t channels) {
+    if (!valid_dimensions(width, height, channels)) {
+        return (planar_image_t) {0};
+    }
+
+    float* storage = arena_calloc(scratch, 1, planar_storage_size(width, height, channels));
+    if (!storage) {
+        return (planar_image_t) {0};
+    }
+
+    return planar_layout(storage, width, height, channels);
+}
+
+
+// Splits rows [top, bottom) of interleaved pixels into the rows of `planar`
+static void load_planar_rows(const image_t* image, size_t top, size_t bottom, planar_image_t* planar) {
+    for (size_t y = top; y < bottom; y++) {
+        const pixel_t* src = &image->data[y * image->width * image->channels];
+        for (size_t c = 0; c < image->channels; c++) {
+            float* row = planar_row(planar, c, y - top);
+            for (size_t x = 0; x < image->width; x++) {
+                row[x] = (float) PIXEL_TO_UNIT(src[x * image->channels + c]);
+            }
+        }
+    }
+}
+
+
+// Splits interleaved pixels into float planes
+planar_image_t make_planar(const image_t* image) {
+    if (!image || !image->data) {
+        return (planar_image_t) {0};
+    }
+
+    planar_image_t planar = make_planar_blank(image->width, image->height, image->channels);
+    if (!planar.storage) {
+        return planar;
+    }
+
+    load_planar_rows(image, 0, image->height, &planar);
+    return planar;
+}
+
+
+// Merges float planes back into an interleaved image
+image_t make_interleaved(const planar_image_t* planar) {
+    if (!planar || !planar->storage) {
+        return (image_t) {0};
+    }
+
+    pixel_t* data = calloc(planar->width * planar->height * planar->channels, sizeof(*data));
+    if (!data) {
+        fprintf(stderr, "Error: Failed to allocate memory for image data!\n");
+        return (image_t) {0};
+    }
+
+    for (size_t y = 0; y < planar->height; y++) {
+        pixel_t* dst = &data[y * planar->width * planar->channels];
+        for (size_t c = 0; c < planar->channels; c++) {
+            const float* row = planar_row(planar, c, y);
+            for (size_t x = 0; x < planar->width; x++) {
+#ifdef ASCIIVIEW_DOUBLE_PIXELS
+                dst[x * planar->channels + c] = row[x];
+#else
+                dst[x * planar->channels + c] = (pixel_t) (clamp_unit(row[x]) * PIXEL_MAX + 0.5f);
+#endif
+            }
+        }
+    }
+
+    return (image_t) {
+        .width = planar->width,
+        .height = planar->height,
+        .channels = planar->channels,
+        .data = data
+    };
+}
+
+
+void free_planar(planar_image_t* planar) {
+    if (planar && planar->storage) {
+        free(planar->storage);
+        *planar = (planar_image_t) {0};
+    }
+}
+
+
+// Area-averaging resize. Each output row first sums its source rows into a
+// unit-stride accumulator, then reduces that row horizontally.
+// Box-average resize over a summed-area table accumulated in double, so
+// large spans keep full float precision. Like make_resized(), only the table
+// rows at span boundaries are kept and each cell is four lookups.
+planar_image_t make_planar_resized(const planar_image_t* original, size_t width, size_t height) {
+    planar_image_t resized = make_planar_blank(width, height, original->channels);
+    if (!resized.storage) {
+        return resized;
+    }
+
+    size_t sat_length = original->width + 1;
+    double* sat_top = aligned_calloc(2 * sat_length * sizeof(*sat_top));
+    size_t* column_spans = malloc(2 * width * sizeof(*column_spans));
+    if (!sat_top || !column_spans) {
+        fprintf(stderr, "Error: Failed to allocate memory for resized image!\n");
+        free(sat_top);
+        free(column_spans);
+        free_planar(&resized);
+        return resized;
+    }
+    double* sat_bottom = sat_top + sat_length;
+
+    for (size_t i = 0; i < width; i++) {
+        get_resize_span(i, width, original->width, &column_spans[2 * i], &column_spans[2 * i + 1]);
+    }
+
+    for (size_t c = 0; c < original->channels; c++) {
+        memset(sat_top, 0, 2 * sat_length * sizeof(*sat_top));
+        size_t top_y = 0, bottom_y = 0;
+
+        for (size_t j = 0; j < height; j++) {
+            size_t y1, y2;
+            get_resize_span(j, height, original->height, &y1, &y2);
+
+            // Spans never move backwards, and a new y1 always equals the previous y2
+            if (y1 != top_y) {
+                memcpy(sat_top, sat_bottom, sat_length * sizeof(*sat_top));
+                top_y = y1;
+            }
+            for (; bottom_y < y2; bottom_y++) {
+                const float* row = planar_row(original, c, bottom_y);
+                double running = 0.0;
+                for (size_t x = 0; x < original->width; x++) {
+                    running += row[x];
+                    sat_bottom[x + 1] += running;
+                }
+            }
+
+            float* out = planar_row(&resized, c, j);
+            for (size_t i = 0; i < width; i++) {
+                size_t x1 = column_spans[2 * i], x2 = column_spans[2 * i + 1];
+                double total = (sat_bottom[x2] - sat_bottom[x1]) - (sat_top[x2] - sat_top[x1]);
+                out[i] = (float) (total / (double) ((x2 - x1) * (y2 - y1)));
+            }
+        }
+    }
+
+    free(sat_top);
+    free(column_spans);
+    return resized;
+}
+
+
+// Applies a 3x3 kernel in place, keeping edge pixels. Only the original rows
+// y - 1 and y are saved, so the temporary is a few rows rather than a plane.
+// With `amount` > 0 the kernel is treated as a blur for an unsharp mask.
+static void convolve_in_place(planar_image_t* image, const float* kernel, float amount) {
+    if (image->width < 3 || image->height < 3) return;
+
+    size_t width = image->width;
+    float* saved = aligned_calloc(3 * image->stride * sizeof(*saved));
+    if (!saved) {
+        fprintf(stderr, "Error: Failed to allocate memory for convolution!\n");
+        return;
+    }
+    float* above = saved;
+    float* row = saved + image->stride;
+    float* filtered = saved + 2 * image->stride;
+
+    for (size_t c = 0; c < image->channels; c++) {
+        memcpy(above, planar_row(image, c, 0), width * sizeof(*above));
+        memcpy(row, planar_row(image, c, 1), width * sizeof(*row));
+
+        for (size_t y = 1; y + 1 < image->height; y++) {
+            float* out = planar_row(image, c, y);
+            const float* below = planar_row(image, c, y + 1);
+
+            convolve_row_f32(above, row, below, filtered, width, kernel);
+
+            for (size_t x = 1; x + 1 < width; x++) {
+                float value = filtered[x];
+                if (amount > 0.0f) {
+                    // Unsharp mask formula: original + amount * (original - blurred)
+                    value = row[x] + amount * (row[x] - value);
+                }
+                out[x] = clamp_unit(value);
+            }
+
+            // Rotate saved rows: the original of row y + 1 becomes current
+            float* recycled = above;
+            above = row;
+            row = recycled;
+            memcpy(row, below, width * sizeof(*row));
+        }
+    }
+
+    free(saved);
+}
+
+
+// Sharpening filter - enhances edges and details
+void planar_sharpen(planar_image_t* image, float strength) {
+    if (!image || !image->storage || strength <= 0.0f) return;
+
+    float kernel[] = {
+        0.0f, -strength, 0.0f,
+        -strength, 1.0f + 4.0f * strength, -strength,
+        0.0f, -strength, 0.0f
+    };
+
+    convolve_in_place(image, kernel, 0.0f);
+}
+
+
+// Clamps a window index to [0, count - 1]
+static size_t clamp_index(ptrdiff_t index, size_t count) {
+    if (index < 0) return 0;
+    if ((size_t) index >= count) return count - 1;
+    return (size_t) index;
+}
+
+
+// Horizontal box filter of one plane with a sliding sum, clamping at the edges
+static void box_blur_rows(const float* src, float* dst, size_t width, size_t height, size_t stride,
+                          size_t radius) {
+    float scale = 1.0f / (float) (2 * radius + 1);
+    for (size_t y = 0; y < height; y++) {
+        const float* row = src + y * stride;
+        float* out = dst + y * stride;
+
+        double sum = 0.0;
+        for (ptrdiff_t k = -(ptrdiff_t) radius; k <= (ptrdiff_t) radius; k++) {
+            sum += row[clamp_index(k, width)];
+        }
+        for (size_t x = 0; x < width; x++) {
+            out[x] = (float) sum * scale;
+            sum += row[clamp_index((ptrdiff_t) (x + radius + 1), width)];
+            sum -= row[clamp_index((ptrdiff_t) x - (ptrdiff_t) radius, width)];
+        }
+    }
+}
+
+
+// Vertical box filter of one plane, one running sum per column
+static void box_blur_columns(const float* src, float* dst, size_t width, size_t height, size_t stride,
+                             size_t radius, double* sums) {
+    float scale = 1.0f / (float) (2 * radius + 1);
+
+    memset(sums, 0, width * sizeof(*sums));
+    for (ptrdiff_t k = -(ptrdiff_t) radius; k <= (ptrdiff_t) radius; k++) {
+        const float* row = src + clamp_index(k, height) * stride;
+        for (size_t x = 0; x < width; x++) {
+            sums[x] += row[x];
+        }
+    }
+
+    for (size_t y = 0; y < height; y++) {
+        const float* entering = src + clamp_index((ptrdiff_t) (y + radius + 1), height) * stride;
+        const float* leaving = src + clamp_index((ptrdiff_t) y - (ptrdiff_t) radius, height) * stride;
+        float* out = dst + y * stride;
+        for (size_t x = 0; x < width; x++) {
+            out[x] = (float) sums[x] * scale;
+            sums[x] += entering[x] - (double) leaving[x];
+        }
+    }
+}
+
+
+// Unsharp mask with a three-pass box approximation of a Gaussian blur.
+// Cost per pixel does not depend on the radius; edges are clamped.
+static void box_unsharp_mask(planar_image_t* image, float amount, float radius) {
+    size_t plane_size = image->stride * image->height;
+    float* blurred = aligned_calloc(2 * plane_size * sizeof(*blurred));
+    double* sums = aligned_calloc(image->width * sizeof(*sums));
+    if (!blurred || !sums) {
+        fprintf(stderr, "Error: Failed to allocate memory for unsharp mask!\n");
+        free(blurred);
+        free(sums);
+        return;
+    }
+    float* temp = blurred + plane_size;
+
+    size_t radii[3];
+    get_box_blur_radii(radius, radii);
+
+    for (size_t c = 0; c < image->channels; c++) {
+        const float* src = image->planes[c];
+        for (int pass = 0; pass < 3; pass++) {
+            box_blur_rows(src, temp, image->width, image->height, image->stride, radii[pass]);
+            box_blur_columns(temp, blurred, image->width, image->height, image->stride, radii[pass], sums);
+            src = blurred;
+        }
+
+        for (size_t y = 0; y < image->height; y++) {
+            float* row = planar_row(image, c, y);
+            const float* blur = blurred + y * image->stride;
+            for (size_t x = 0; x < image->width; x++) {
+                row[x] = clamp_unit(row[x] + amount * (row[x] - blur[x]));
+            }
+        }
+    }
+
+    free(blurred);
+    free(sums);
+}
+
+
+// Unsharp mask - sharpened = original + amount * (original - blurred)
+// Radius (Gaussian sigma, in pixels) up to 1.0 keeps the fixed 3x3 kernel.
+void planar_unsharp_mask(planar_image_t* image, float amount, float radius) {
+    if (!image || !image->storage || amount <= 0.0f) return;
+
+    if (radius > 1.0f) {
+        box_unsharp_mask(image, amount, radius);
+        return;
+    }
+
+    float blur_kernel[] = {
+        1.0f/16, 2.0f/16, 1.0f/16,
+        2.0f/16, 4.0f/16, 2.0f/16,
+        1.0f/16, 2.0f/16, 1.0f/16
+    };
+
+    convolve_in_place(image, blur_kernel, amount);
+
+    // Edge pixels have no blurred value (zero), matching unsharp_mask()
+    for (size_t c = 0; c < image->channels; c++) {
+        for (size_t y = 0; y < image->height; y++) {
+            float* row = planar_row(image, c, y);
+            int edge_row = (y == 0 || y + 1 == image->height || image->width < 3 || image->height < 3);
+            for (size_t x = 0; x < image->width; x++) {
+                if (edge_row || x == 0 || x + 1 == image->width) {
+                    row[x] = clamp_unit(row[x] * (1.0f + amount));
+                }
+            }
+        }
+    }
+}
+
+
+// Sharpens `original` at full resolution and box-averages it down to
+// width x height, with the result of make_planar(), planar_unsharp_mask()
+// and make_planar_resized() but without a float copy of the whole original.
+// Source rows are converted and sharpened a strip at a time, with the
+// filter's reach of extra rows on either side, so the rows kept match a
+// whole-image pass. The summed-area tables then take them in order.
+planar_image_t make_planar_sharpened_resized(const image_t* original, size_t width, size_t height,
+                                             float amount, float radius) {
+    if (!original || !original->data) {
+        return (planar_image_t) {0};
+    }
+    planar_image_t resized = make_planar_blank(width, height, original->channels);
+    if (!resized.storage) {
+        return resized;
+    }
+
+    // A short last strip joins the one before, so every strip below the
+    // first has rows to spare for the 3x3 kernel's edges
+    size_t halo = unsharp_mask_halo(radius);
+    size_t strip_capacity = PLANAR_STRIP_ROWS + PLANAR_STRIP_ROWS / 2 + 2 * halo;
+    if (strip_capacity > original->height) strip_capacity = original->height;
+
+    size_t channels = original->channels;
+    size_t sat_length = original->width + 1;
+    float* strip_storage = aligned_calloc(planar_storage_size(original->width, strip_capacity, channels));
+    double* sat = aligned_calloc(2 * channels * sat_length * sizeof(*sat));
+    size_t* column_spans = malloc(2 * width * sizeof(*column_spans));
+    if (!strip_storage || !sat || !column_spans) {
+        fprintf(stderr, "Error: Failed to allocate memory for resized image!\n");
+        free(strip_storage);
+        free(sat);
+        free(column_spans);
+        free_planar(&resized);
+        return resized;
+    }
+
+    for (size_t i = 0; i < width; i++) {
+        get_resize_span(i, width, original->width, &column_spans[2 * i], &column_spans[2 * i + 1]);
+    }
+
+    planar_image_t strip = {0};
+    size_t strip_top = 0, strip_end = 0;
+    size_t top_y = 0, bottom_y = 0;
+    for (size_t j = 0; j < height; j++) {
+        size_t y1, y2;
+        get_resize_span(j, height, original->height, &y1, &y2);
+
+        // Spans never move backwards, and a new y1 always equals the previous y2
+        if (y1 != top_y) {
+            for (size_t c = 0; c < channels; c++) {
+                double* sat_top = sat + 2 * c * sat_length;
+                memcpy(sat_top, sat_top + sat_length, sat_length * sizeof(*sat));
+            }
+            top_y = y1;
+        }
+        for (; bottom_y < y2; bottom_y++) {
+            if (bottom_y >= strip_end) {
+                strip_end = bottom_y + PLANAR_STRIP_ROWS;
+                if (strip_end >= original->height || original->height - strip_end < PLANAR_STRIP_ROWS / 2) {
+                    strip_end = original->height;
+                }
+                strip_top = bottom_y > halo ? bottom_y - halo : 0;
+                size_t strip_bottom = strip_end + halo < original->height ? strip_end + halo : original->height;
+                strip = planar_layout(strip_storage, original->width, strip_bottom - strip_top, channels);
+                load_planar_rows(original, strip_top, strip_bottom, &strip);
+                planar_unsharp_mask(&strip, amount, radius);
+            }
+            for (size_t c = 0; c < channels; c++) {
+                const float* row = planar_row(&strip, c, bottom_y - strip_top);
+                double* sat_bottom = sat + (2 * c + 1) * sat_length;
+                double running = 0.0;
+                for (size_t x = 0; x < original->width; x++) {
+                    running += row[x];
+                    sat_bottom[x + 1] += running;
+                }
+            }
+        }
+
+        for (size_t c = 0; c < channels; c++) {
+            const double* sat_top = sat + 2 * c * sat_length;
+            const double* sat_bottom = sat_top + sat_length;
+            float* out = planar_row(&resized, c, j);
+            for (size_t i = 0; i < width; i++) {
+                size_t x1 = column_spans[2 * i], x2 = column_spans[2 * i + 1];
+                double total = (sat_bottom[x2] - sat_bottom[x1]) - (sat_top[x2] - sat_top[x1]);
+                out[i] = (float) (total / (double) ((x2 - x1) * (y2 - y1)));
+            }
+        }
+    }
+
+    free(strip_storage);
+    free(sat);
+    free(column_spans);
+    return resized;
+}
+
+
+// Sobel gradients of one row from its rows above and below. Writes
+// out_x/out_y[1 .. width - 2]; callers keep the edge columns.
+void planar_sobel_row(const float* above, const float* row, const float* below,
+                      float* out_x, float* out_y, size_t width) {
+    static const float Gx[] = {-1.f, 0.f, 1.f, -2.f, 0.f, 2.f, -1.f, 0.f, 1.f};
+    static const float Gy[] = {1.f, 2.f, 1.f, 0.f, 0.f, 0.f, -1.f, -2.f, -1.f};
+
+    convolve_row_f32(above, row, below, out_x, width, Gx);
+    convolve_row_f32(above, row, below, out_y, width, Gy);
+}
+
+
+// Sobel gradients of one channel into a two-plane image (x, y). Edges stay zero.
+void planar_sobel(const planar_image_t* image, size_t channel, planar_image_t* gradients) {
+    for (size_t y = 1; y + 1 < image->height; y++) {
+        planar_sobel_row(planar_row(image, channel, y - 1), planar_row(image, channel, y),
+                         planar_row(image, channel, y + 1),
+                         planar_row(gradients, 0, y), planar_row(gradients, 1, y), image->width);
+    }
+}
@@ -34,9 +34,15 @@
 #include <math.h>
 #include <string.h>
 #include <unistd.h>
-#include <time.h>
 
 #include "../include/image.h"
+#include "../include/planar_image.h"
+#include "../include/frame_buffer.h"
+#include "../include/cell_grid.h"
+#include "../include/frame_store.h"
+#include "../include/print_image.h"
+#include "../include/frame_scheduler.h"
+#include "../include/monotonic_clock.h"
 #include "../include/argparse.h"
 
 // Enhanced character ramp with better perceptual spacing (70+ levels)
@@ -52,19 +58,47 @@
 #define SIMPLE_CHARS " .:-=+*#%@"
 #define N_SIMPLE (sizeof(SIMPLE_CHARS) - 1)
 
+// UTF-8 bytes of a glyph, zero padded, with its length precomputed
+typedef struct {
+    char bytes[GLYPH_MAX_BYTES];
+    size_t length;
+} glyph_t;
+#define GLYPH(s) { s, sizeof(s) - 1 }
+
 // Braille patterns for higher detail (8 levels)
-static const char* BRAILLE_CHARS[] = {
-    " ", "⠁", "⠃", "⠇", "⠏", "⠟", "⠿", "⣿"
+static const glyph_t BRAILLE_CHARS[] = {
+    GLYPH(" "), GLYPH("⠁"), GLYPH("⠃"), GLYPH("⠇"),
+    GLYPH("⠏"), GLYPH("⠟"), GLYPH("⠿"), GLYPH("⣿")
 };
 #define N_BRAILLE 8
 
-// Color ANSI codes
-#define RESET "\x1b[0m"
-
 // Contrast enhancement parameters
 #define CLIP_LIMIT 2.0
 #define TILE_SIZE 8
 
+// Stable contrast: histogram sampling stride in cells, weight of each new
+// frame in the average, and the L1 histogram distance (0 to 2) taken as a
+// scene cut
+#define CONTRAST_SAMPLE_STEP 2
+#define CONTRAST_SMOOTHING 0.125
+#define CONTRAST_SCENE_CUT 0.75
+
+// Gamma table layout: weighted BT.601 sums below LUMA_EXACT_SUMS get one
+// entry each, larger sums are interpolated between entries LUMA_STEP apart
+#define LUMA_EXACT_SUMS 4096
+#define LUMA_STEP_SHIFT 6
+#define LUMA_STEP (1 << LUMA_STEP_SHIFT)
+#define LUMA_MAX_SUM (1000 * 255)
+#define LUMA_COARSE_ENTRIES (((LUMA_MAX_SUM - LUMA_EXACT_SUMS) >> LUMA_STEP_SHIFT) + 2)
+
+// Glyph ramps are looked up through GLYPH_BINS luminance bins
+#define GLYPH_BINS 1024
+#define GLYPH_MAX_LEVELS N_ENHANCED
+
+// tan(22.5) and tan(67.5) bound the edge orientation sectors
+#define TAN_22_5 0.41421356237309503
+#define TAN_67_5 2.4142135623730949
+
 
 typedef struct {
     double hue;
@@ -155,18 +189,77 @@ static void hsv_to_rgb(const hsv_t* hsv, double* r, double* g, double* b) {
 // Multi-stage approach for high fidelity ASCII mapping
 // ============================================================================
 
+// Gamma-compensated luminance by weighted sum, built once by init_lookup_tables()
+static float luma_exact[LUMA_EXACT_SUMS];
+static float luma_coarse[LUMA_COARSE_ENTRIES];
+
+
 // Calculate perceptually accurate luminance (ITU-R BT.601)
 // Using simplified formula with gamma compensation as per requirements
-static double calculate_luminance(double r, double g, double b) {
+static double calculate_luminance(const pixel_t* pixel) {
     // ITU-R BT.601 standard weights (NTSC/PAL)
     // L = 0.299*R + 0.587*G + 0.114*B
-    double luminance = 0.299 * r + 0.587 * g + 0.114 * b;
+#ifdef ASCIIVIEW_DOUBLE_PIXELS
+    double luminance = 0.299 * pixel[0] + 0.587 * pixel[1] + 0.114 * pixel[2];
     
     // Apply gamma compensation for better perceptual gradation
     // L_gamma = (L)^(1/2.2)
-    double gamma_compensated = pow(luminance, 1.0 / 2.2);
+    return pow(luminance, 1.0 / 2.2);
+#else
+    // Weights scaled to an integer sum of 1000, so the weighted sum is exact
+    // and keys the gamma table directly. The curve is steepest near black,
+    // where every sum has its own entry; above that, linear interpolation
+    // between entries LUMA_STEP sums apart stays within 1.2e-6 of the exact
+    // pow(L, 1 / 2.2), well under the 1 / 255 histogram bin width.
+    uint32_t weighted = 299u * pixel[0] + 587u * pixel[1] + 114u * pixel[2];
+    if (weighted < LUMA_EXACT_SUMS) {
+        return luma_exact[weighted];
+    }
+    uint32_t offset = weighted - LUMA_EXACT_SUMS;
+    uint32_t index = offset >> LUMA_STEP_SHIFT;
+    float fraction = (float)(offset & (LUMA_STEP - 1)) * (1.0f / LUMA_STEP);
+    return luma_coarse[index] + (luma_coarse[index + 1] - luma_coarse[index]) * fraction;
+#endif
+}
+
+
+// Truecolor mode: boost saturation by 15% while keeping hue and value.
+// With hue and value fixed, each channel is c' = V - k * (V - c) where
+// k = S' / S = min(1.15, V / chroma), so 8-bit pixels stay in integers.
+static void boost_saturation(const pixel_t* pixel, int* out_r, int* out_g, int* out_b) {
+#ifdef ASCIIVIEW_DOUBLE_PIXELS
+    hsv_t hsv = rgb_to_hsv(pixel[0], pixel[1], pixel[2]);
+    hsv.saturation = fmin(hsv.saturation * 1.15, 1.0);
+    
+    double r_d, g_d, b_d;
+    hsv_to_rgb(&hsv, &r_d, &g_d, &b_d);
+    *out_r = (int)(r_d * 255);
+    *out_g = (int)(g_d * 255);
+    *out_b = (int)(b_d * 255);
+#else
+    int rgb[3] = {pixel[0], pixel[1], pixel[2]};
+    int value = rgb[0];
+    int minimum = rgb[0];
+    for (int c = 1; c < 3; c++) {
+        if (rgb[c] > value) value = rgb[c];
+        if (rgb[c] < minimum) minimum = rgb[c];
+    }
+    int chroma = value - minimum;
     
-    return gamma_compensated;
+    for (int c = 0; c < 3 && chroma > 0; c++) {
+        int offset = value - rgb[c];
+        if (115 * chroma >= 100 * value) {
+            // Saturation clamps to 1.0: k = V / chroma
+            rgb[c] = value - (value * offset + chroma / 2) / chroma;
+        } else {
+            rgb[c] = value - (115 * offset + 50) / 100;
+        }
+    }
+    
+    *out_r = rgb[0];
+    *out_g = rgb[1];
+    *out_b = rgb[2];
+#endif
 }
 
 
@@ -174,27 +267,35 @@ static double calculate_luminance(double r, double g, double b) {
 // Adaptive Contrast Enhancement (Simplified CLAHE)
 // ============================================================================
 
-static void enhance_contrast_adaptive(double* values, size_t width, size_t height) {
-    if (!values || width == 0 || height == 0) return;
-    
-    // Build histogram
-    int histogram[256] = {0};
-    for (size_t i = 0; i < width * height; i++) {
-        int bin = (int)(values[i] * 255.0);
-        if (bin < 0) bin = 0;
-        if (bin > 255) bin = 255;
-        histogram[bin]++;
+// Grayscale row for edge detection, in the planar float format
+static void load_gray_row(image_t* image, size_t y, float* row) {
+    for (size_t x = 0; x < image->width; x++) {
+        row[x] = (float) PIXEL_TO_UNIT(pixel_grayscale(get_pixel(image, x, y), image->channels));
     }
-    
+}
+
+
+// Histogram bin of a luminance value
+static int contrast_bin(double value) {
+    int bin = (int)(value * 255.0);
+    if (bin < 0) bin = 0;
+    if (bin > 255) bin = 255;
+    return bin;
+}
+
+
+// Builds the histogram-equalization curve (equalized value per bin). The
+// histogram holds pixel counts or, for stable contrast, averaged fractions.
+static void build_contrast_curve(const double histogram[256], double curve[256]) {
     // Compute cumulative distribution function
-    int cdf[256];
+    double cdf[256];
     cdf[0] = histogram[0];
     for (int i = 1; i < 256; i++) {
         cdf[i] = cdf[i-1] + histogram[i];
     }
     
     // Find min non-zero CDF value
-    int cdf_min = cdf[0];
+    double cdf_min = cdf[0];
     for (int i = 0; i < 256; i++) {
         if (cdf[i] > 0) {
             cdf_min = cdf[i];
@@ -202,24 +303,82 @@ static void enhance_contrast_adaptive(double* values, size_t width, size_t heigh
         }
     }
     
-    // Apply histogram equalization with adaptive clipping
-    int total_pixels = width * height;
-    for (size_t i = 0; i < width * height; i++) {
-        int bin = (int)(values[i] * 255.0);
-        if (bin < 0) bin = 0;
-        if (bin > 255) bin = 255;
-        
-        // Equalized value
-        double equalized = (double)(cdf[bin] - cdf_min) / (double)(total_pixels - cdf_min);
-        
-        // Blend with original (adaptive strength based on local contrast)
-        double blend_factor = 0.6; // 60% equalized, 40% original
-        values[i] = blend_factor * equalized + (1.0 - blend_factor) * values[i];
-        
-        // Clamp
-        if (values[i] < 0.0) values[i] = 0.0;
-        if (values[i] > 1.0) values[i] = 1.0;
+    double total = cdf[255];
+    for (int i = 0; i < 256; i++) {
+        curve[i] = (cdf[i] - cdf_min) / (total - cdf_min);
+    }
+}
+
+
+// How far a frame's pixels would move between two curves, on average
+static double contrast_drift(const double fractions[256], const double from[256], const double to[256]) {
+    double sum = 0.0;
+    for (int i = 0; i < 256; i++) {
+        if (fractions[i] > 0.0) sum += fractions[i] * fabs(to[i] - from[i]);
+    }
+    return sum;
+}
+
+
+// Folds a frame into the averaged histogram and builds the curve from it.
+// Only every CONTRAST_SAMPLE_STEP-th row and column is binned.
+static void build_stable_contrast_curve(contrast_history_t* history, const double* luminance,
+                                        size_t width, size_t height, double curve[256]) {
+    int counts[256] = {0};
+    size_t samples = 0;
+    for (size_t y = 0; y < height; y += CONTRAST_SAMPLE_STEP) {
+        const double* luminance_row = luminance + y * width;
+        for (size_t x = 0; x < width; x += CONTRAST_SAMPLE_STEP) {
+            counts[contrast_bin(luminance_row[x])]++;
+            samples++;
+        }
+    }
+
+    if (samples == 0) samples = 1;
+
+    double fractions[256];
+    double distance = 0.0;
+    for (int i = 0; i < 256; i++) {
+        fractions[i] = (double) counts[i] / (double) samples;
+        distance += fabs(fractions[i] - history->histogram[i]);
     }
+
+    if (!history->primed || distance > CONTRAST_SCENE_CUT) {
+        history->scene_cuts += history->primed;
+        history->primed = 1;
+        memcpy(history->histogram, fractions, sizeof(fractions));
+    } else {
+        for (int i = 0; i < 256; i++) {
+            history->histogram[i] += CONTRAST_SMOOTHING * (fractions[i] - history->histogram[i]);
+        }
+    }
+    build_contrast_curve(history->histogram, curve);
+
+    // Unchanged pixels move with the curve; compare with per-frame curves
+    double own_curve[256];
+    build_contrast_curve(fractions, own_curve);
+    if (history->frames++ > 0) {
+        history->drift += contrast_drift(fractions, history->curve, curve);
+        history->drift_raw += contrast_drift(fractions, history->curve_raw, own_curve);
+    }
+    memcpy(history->curve, curve, sizeof(history->curve));
+    memcpy(history->curve_raw, own_curve, sizeof(history->curve_raw));
+}
+
+
+// Applies histogram equalization with adaptive clipping
+static double apply_contrast(double value, const double curve[256]) {
+    // Equalized value
+    double equalized = curve[contrast_bin(value)];
+    
+    // Blend with original (adaptive strength based on local contrast)
+    double blend_factor = 0.6; // 60% equalized, 40% original
+    value = blend_factor * equalized + (1.0 - blend_factor) * value;
+    
+    // Clamp
+    if (value < 0.0) value = 0.0;
+    if (value > 1.0) value = 1.0;
+    return value;
 }
 
 
@@ -258,28 +417,104 @@ static void get_retro_rgb(const hsv_t* hsv, int* out_r, int* out_g, int* out_b)
 // Enhanced ASCII Character Selection
 // ============================================================================
 
-static char get_ascii_char_simple(double luminance) {
+// Character ramp with its glyph index precomputed per luminance bin. The
+// index is (size_t)(pow(L, gamma) * (levels - 1)), which only changes at
+// the thresholds; a bin holds the index at its lower edge and the lookup
+// steps past any threshold inside the bin, so glyphs match the pow() form
+// exactly with no per-cell transcendental.
+typedef struct {
+    size_t levels;
+    double gamma;
+    double thresholds[GLYPH_MAX_LEVELS + 1];
+    uint8_t bin_level[GLYPH_BINS + 1];
+} glyph_ramp_t;
+
+static glyph_ramp_t simple_ramp = { .levels = N_SIMPLE, .gamma = 0.9 };
+static glyph_ramp_t enhanced_ramp = { .levels = N_ENHANCED, .gamma = 0.9 };
+static glyph_ramp_t braille_ramp = { .levels = N_BRAILLE, .gamma = 0.85 };
+
+
+static size_t ramp_level_exact(const glyph_ramp_t* ramp, double luminance) {
     // Apply subtle gamma correction for better perceptual spacing
-    double adjusted = pow(luminance, 0.9);
+    double adjusted = pow(luminance, ramp->gamma);
     
-    size_t index = (size_t)(adjusted * (N_SIMPLE - 1));
+    size_t index = (size_t)(adjusted * (ramp->levels - 1));
     
-    if (index >= N_SIMPLE) {
-        index = N_SIMPLE - 1;
+    if (index >= ramp->levels) {
+        index = ramp->levels - 1;
     }
+    return index;
+}
+
 
-    return SIMPLE_CHARS[index];
+// Least luminance in [0, 1] whose level is at least `level`, by bisection
+static double ramp_threshold(const glyph_ramp_t* ramp, size_t level) {
+    double low = 0.0;
+    double high = 1.0;
+    for (;;) {
+        double mid = low + (high - low) / 2.0;
+        if (mid <= low || mid >= high) break;
+        if (ramp_level_exact(ramp, mid) >= level) {
+            high = mid;
+        } else {
+            low = mid;
+        }
+    }
+    return high;
 }
 
-static const char* get_braille_char(double luminance) {
-    double adjusted = pow(luminance, 0.85);
-    size_t index = (size_t)(adjusted * (N_BRAILLE - 1));
-    
-    if (index >= N_BRAILLE) {
-        index = N_BRAILLE - 1;
+
+static void build_glyph_ramp(glyph_ramp_t* ramp) {
+    ramp->thresholds[0] = 0.0;
+    for (size_t level = 1; level < ramp->levels; level++) {
+        ramp->thresholds[level] = ramp_threshold(ramp, level);
     }
-    
-    return BRAILLE_CHARS[index];
+    ramp->thresholds[ramp->levels] = INFINITY;
+
+    size_t level = 0;
+    for (size_t bin = 0; bin <= GLYPH_BINS; bin++) {
+        double edge = (double) bin / GLYPH_BINS;
+        while (edge >= ramp->thresholds[level + 1]) level++;
+        ramp->bin_level[bin] = (uint8_t) level;
+    }
+}
+
+
+static size_t ramp_level(const glyph_ramp_t* ramp, double luminance) {
+    // NaN (flat single-value frames) maps to the top level as pow() did
+    if (luminance < 0.0) luminance = 0.0;
+    if (!(luminance <= 1.0)) luminance = 1.0;
+    size_t level = ramp->bin_level[(size_t)(luminance * GLYPH_BINS)];
+    while (luminance >= ramp->thresholds[level + 1]) level++;
+    return level;
+}
+
+
+static void init_lookup_tables(void) {
+    static int initialized = 0;
+    if (initialized) return;
+
+    for (uint32_t sum = 0; sum < LUMA_EXACT_SUMS; sum++) {
+        luma_exact[sum] = (float) pow(sum / (double) LUMA_MAX_SUM, 1.0 / 2.2);
+    }
+    for (uint32_t i = 0; i < LUMA_COARSE_ENTRIES; i++) {
+        uint32_t sum = LUMA_EXACT_SUMS + (i << LUMA_STEP_SHIFT);
+        luma_coarse[i] = (float) pow(sum / (double) LUMA_MAX_SUM, 1.0 / 2.2);
+    }
+
+    build_glyph_ramp(&simple_ramp);
+    build_glyph_ramp(&enhanced_ramp);
+    build_glyph_ramp(&braille_ramp);
+    initialized = 1;
+}
+
+
+static char get_ascii_char(const glyph_ramp_t* ramp, const char* chars, double luminance) {
+    return chars[ramp_level(ramp, luminance)];
+}
+
+static const glyph_t* get_braille_char(double luminance) {
+    return &BRAILLE_CHARS[ramp_level(&braille_ramp, luminance)];
 }
 
 
@@ -287,19 +522,19 @@ static const char* get_braille_char(double luminance) {
 // Improved Edge Detection
 // ============================================================================
 
-static char get_edge_char_by_angle(double angle) {
-    // More accurate angle-to-character mapping
-    if ((22.5 <= angle && angle <= 67.5) || 
-        (-157.5 <= angle && angle <= -112.5))
-        return '/';
-    else if ((67.5 <= angle && angle <= 112.5) || 
-             (-112.5 <= angle && angle <= -67.5))
-        return '-';
-    else if ((112.5 <= angle && angle <= 157.5) || 
-             (-67.5 <= angle && angle <= -22.5))
-        return '\\';
-    else
+// Character for the gradient orientation atan2(sy, sx), picked by comparing
+// |sy| against |sx| scaled by the tangents of the 45-degree sector edges
+static char get_edge_char(double sx, double sy) {
+    double ax = fabs(sx);
+    double ay = fabs(sy);
+    if (ay <= TAN_22_5 * ax) {
         return '|';
+    }
+    if (ay > TAN_67_5 * ax) {
+        return '-';
+    }
+    // Diagonal sectors: 22.5..67.5 and -157.5..-112.5 degrees share a sign
+    return ((sx >= 0.0) == (sy >= 0.0)) ? '/' : '\\';
 }
 
 
@@ -307,7 +542,85 @@ static char get_edge_char_by_angle(double angle) {
 // Main Printing Function with Enhanced Rendering
 // ============================================================================
 
-void print_image_with_options(image_t* image, args_t* args);
+void render_context_init(render_context_t* ctx) {
+    init_lookup_tables();
+    memset(&ctx->hysteresis, 0, sizeof(ctx->hysteresis));
+    memset(&ctx->contrast, 0, sizeof(ctx->contrast));
+    cell_grid_init(&ctx->hysteresis.raw);
+    arena_init(&ctx->scratch);
+    cell_grid_init(&ctx->cells);
+    frame_buffer_init(&ctx->output);
+}
+
+void render_context_free(render_context_t* ctx) {
+    arena_free(&ctx->scratch);
+    cell_grid_free(&ctx->cells);
+    frame_buffer_free(&ctx->output);
+    free(ctx->hysteresis.anchors);
+    cell_grid_free(&ctx->hysteresis.raw);
+}
+
+
+// ============================================================================
+// Temporal Glyph Hysteresis
+// ============================================================================
+
+// Luminance in [0, 1] as a 16-bit anchor; NaN maps to the top like ramp_level()
+static int anchor_level(double luminance) {
+    if (luminance < 0.0) return 0;
+    if (!(luminance <= 1.0)) return 65535;
+    return (int) (luminance * 65535.0 + 0.5);
+}
+
+
+// Sizes the side buffers for a frame. Returns 1 if `previous` is the grid
+// on screen at this size, so cells can be held against it; otherwise every
+// cell is anchored afresh.
+static int hysteresis_begin(glyph_hysteresis_t* hold, const cell_grid_t* previous, size_t width, size_t height) {
+    if (hold->margin <= 0.0 || !previous) return 0;
+
+    int same_size = hold->anchors && hold->width == width && hold->height == height;
+    if (!same_size) {
+        free(hold->anchors);
+        hold->anchors = malloc(width * height * sizeof(*hold->anchors));
+        hold->heap_allocations++;
+        hold->width = hold->anchors ? width : 0;
+        hold->height = hold->anchors ? height : 0;
+        if (hold->count_raw && !cell_grid_resize(&hold->raw, width, height)) {
+            hold->count_raw = 0;
+        }
+    }
+    return same_size && previous->width == width && previous->height == height;
+}
+
+
+// Holds `cell` at the previous frame's cell unless it moved past the margin
+static void hysteresis_apply(glyph_hysteresis_t* hold, size_t index, double luminance, cell_t* cell,
+                             const cell_t* before, int holding) {
+    int level = anchor_level(luminance);
+    if (hold->count_raw) {
+        cell_t* raw = &hold->raw.cells[index];
+        hold->changed_raw += holding && !cell_equal(cell, raw);
+        *raw = *cell;
+    }
+    if (!holding) {
+        hold->anchors[index] = (uint16_t) level;
+        return;
+    }
+
+    int margin = (int) (hold->margin * 65535.0);
+    int color_margin = (int) (hold->margin * 255.0);
+    int close = abs(level - hold->anchors[index]) <= margin;
+    for (int c = 0; c < 3 && close; c++) {
+        close = abs(cell->rgb[c] - before->rgb[c]) <= color_margin;
+    }
+    if (close) {
+        *cell = *before;
+    } else {
+        hold->anchors[index] = (uint16_t) level;
+        hold->changed += !cell_equal(cell, before);
+    }
+}
 
 void print_image(image_t* image, double edge_threshold, int use_retro_colors, int use_braille, int use_grayscale) {
     args_t args = {
@@ -318,122 +631,149 @@ void print_image(image_t* image, double edge_threshold, int use_retro_colors, in
         .use_enhanced_palette = 0,
         .debug_mode = 0
     };
-    print_image_with_options(image, &args);
+    render_context_t ctx;
+    render_context_init(&ctx);
+    print_image_with_options(&ctx, image, &args);
+    render_context_free(&ctx);
 }
 
-void print_image_with_options(image_t* image, args_t* args) {
+// Renders one frame into ctx->cells. For animations, `previous` is the grid
+// on screen, which glyph hysteresis holds cells at; NULL otherwise. Returns
+// 0 on failure.
+static int render_cells(render_context_t* ctx, image_t* image, args_t* args, const cell_grid_t* previous) {
     double edge_threshold = args->edge_threshold;
     int use_retro_colors = args->use_retro_colors;
     int use_braille = args->use_braille;
     int use_grayscale = args->use_grayscale;
-    // TODO: Implement use_enhanced_palette selection
-    // int use_enhanced = args->use_enhanced_palette;
+    const glyph_ramp_t* ramp = args->use_enhanced_palette ? &enhanced_ramp : &simple_ramp;
+    const char* ramp_chars = args->use_enhanced_palette ? ENHANCED_CHARS : SIMPLE_CHARS;
     if (!image || !image->data) {
         fprintf(stderr, "Error: Invalid image data!\n");
-        return;
+        return 0;
     }
 
-    // Create luminance buffer for better brightness calculation
-    double* luminance_buffer = calloc(image->width * image->height, sizeof(*luminance_buffer));
+    // Scratch buffers from the previous frame are released here
+    arena_reset(&ctx->scratch);
+
+    size_t width = image->width;
+    size_t height = image->height;
+    size_t channels = image->channels;
+
+    cell_grid_t* cells = &ctx->cells;
+    if (!cell_grid_resize(cells, width, height)) {
+        return 0;
+    }
+
+    // Luminance pre-pass. Contrast mapping needs the histogram of the whole
+    // frame before the first cell, so this is the only full-frame buffer.
+    double* luminance_buffer = arena_alloc(&ctx->scratch, width * height * sizeof(*luminance_buffer));
     if (!luminance_buffer) {
         fprintf(stderr, "Error: Failed to allocate luminance buffer!\n");
-        return;
+        return 0;
     }
 
-    // Calculate accurate luminance for each pixel
-    for (size_t y = 0; y < image->height; y++) {
-        for (size_t x = 0; x < image->width; x++) {
-            double* pixel = get_pixel(image, x, y);
-            size_t index = y * image->width + x;
-            
-            if (image->channels >= 3) {
-                luminance_buffer[index] = calculate_luminance(pixel[0], pixel[1], pixel[2]);
-            } else {
-                luminance_buffer[index] = pixel[0];
-            }
+    // Stable contrast bins a sample of the frame afterwards instead
+    int stable_contrast = ctx->contrast.enabled;
+    int histogram[256] = {0};
+    for (size_t y = 0; y < height; y++) {
+        double* luminance_row = luminance_buffer + y * width;
+        pixel_t* pixel_row = get_pixel(image, 0, y);
+        for (size_t x = 0; x < width; x++) {
+            pixel_t* pixel = pixel_row + x * channels;
+            luminance_row[x] = channels >= 3 ? calculate_luminance(pixel) : PIXEL_TO_UNIT(pixel[0]);
+            if (!stable_contrast) histogram[contrast_bin(luminance_row[x])]++;
         }
     }
 
-    // Apply adaptive contrast enhancement
-    enhance_contrast_adaptive(luminance_buffer, image->width, image->height);
-
-    // Prepare edge detection buffers
-    image_t grayscale = make_grayscale(image);
-    if (!grayscale.data) {
-        fprintf(stderr, "Error: Failed to create grayscale image!\n");
-        free(luminance_buffer);
-        return;
+    double contrast_curve[256];
+    if (stable_contrast) {
+        build_stable_contrast_curve(&ctx->contrast, luminance_buffer, width, height, contrast_curve);
+    } else {
+        double counts[256];
+        for (int i = 0; i < 256; i++) counts[i] = histogram[i];
+        build_contrast_curve(counts, contrast_curve);
     }
 
-    double* sobel_x = calloc(grayscale.width * grayscale.height, sizeof(*sobel_x));
-    double* sobel_y = calloc(grayscale.width * grayscale.height, sizeof(*sobel_y));
-    
-    if (!sobel_x || !sobel_y) {
+    // Rolling window for edge detection: three grayscale rows around the
+    // current one plus its gradients, instead of full-frame planes
+    int use_edges = edge_threshold < 4.0;
+    float* window[3];
+    float* gradient_x = arena_calloc(&ctx->scratch, width, sizeof(*gradient_x));
+    float* gradient_y = arena_calloc(&ctx->scratch, width, sizeof(*gradient_y));
+    for (int i = 0; i < 3; i++) {
+        window[i] = arena_alloc(&ctx->scratch, width * sizeof(*window[i]));
+    }
+    if (!gradient_x || !gradient_y || !window[0] || !window[1] || !window[2]) {
         fprintf(stderr, "Error: Failed to allocate edge detection buffers!\n");
-        free(sobel_x);
-        free(sobel_y);
-        free(luminance_buffer);
-        free_image(&grayscale);
-        return;
+        return 0;
     }
 
-    // Compute edges if enabled
-    if (edge_threshold < 4.0) {
-        get_sobel(&grayscale, sobel_x, sobel_y);
+    if (use_edges) {
+        load_gray_row(image, 0, window[0]);
+        if (height > 1) load_gray_row(image, 1, window[1]);
     }
 
-    // Render each pixel
-    for (size_t y = 0; y < image->height; y++) {
-        for (size_t x = 0; x < image->width; x++) {
-            double* pixel = get_pixel(image, x, y);
-            if (!pixel) continue;
+    glyph_hysteresis_t* hold = &ctx->hysteresis;
+    int holding = hysteresis_begin(hold, previous, width, height);
+    int use_hysteresis = hold->anchors && hold->width == width && hold->height == height && previous;
+    hold->frames += holding;
 
-            size_t index = y * image->width + x;
-            double sx = sobel_x[index];
-            double sy = sobel_y[index];
+    // Single sweep: gradients, contrast mapping, glyph and color per cell
+    for (size_t y = 0; y < height; y++) {
+        const double* luminance_row = luminance_buffer + y * width;
+        cell_t* cell_row = cell_grid_row(cells, y);
+        pixel_t* pixel_row = get_pixel(image, 0, y);
+
+        // Sobel needs rows y - 1 .. y + 1; border rows and columns keep zero gradients
+        if (use_edges && y >= 1 && y + 1 < height) {
+            load_gray_row(image, y + 1, window[(y + 1) % 3]);
+            planar_sobel_row(window[(y - 1) % 3], window[y % 3], window[(y + 1) % 3],
+                             gradient_x, gradient_y, width);
+        } else if (use_edges) {
+            memset(gradient_x, 0, width * sizeof(*gradient_x));
+            memset(gradient_y, 0, width * sizeof(*gradient_y));
+        }
+
+        for (size_t x = 0; x < width; x++) {
+            pixel_t* pixel = pixel_row + x * channels;
+
+            double sx = gradient_x[x];
+            double sy = gradient_y[x];
 
             double edge_magnitude = sqrt(sx * sx + sy * sy);
-            double edge_angle = atan2(sy, sx) * 180.0 / M_PI;
 
             // Get enhanced luminance value
-            double luma = luminance_buffer[index];
+            double luma = apply_contrast(luminance_row[x], contrast_curve);
             
             char ascii_char = ' ';
-            const char* braille_str = NULL;
+            const glyph_t* braille_glyph = NULL;
             int r = 255, g = 255, b = 255;
             
             // Grayscale mode: convert everything to grayscale
-            if (use_grayscale || image->channels <= 2) {
+            if (use_grayscale || channels <= 2) {
                 // Grayscale image or grayscale mode enabled
                 r = g = b = (int)(luma * 255);
                 if (use_braille) {
-                    braille_str = get_braille_char(luma);
+                    braille_glyph = get_braille_char(luma);
                 } else {
-                    ascii_char = get_ascii_char_simple(luma);
+                    ascii_char = get_ascii_char(ramp, ramp_chars, luma);
                 }
             } else {
                 // Color image - preserve original colors accurately
-                hsv_t hsv = rgb_to_hsv(pixel[0], pixel[1], pixel[2]);
-                
                 if (use_retro_colors) {
                     // Retro mode with original brightness
+                    hsv_t hsv = rgb_to_hsv(PIXEL_TO_UNIT(pixel[0]), PIXEL_TO_UNIT(pixel[1]), PIXEL_TO_UNIT(pixel[2]));
                     get_retro_rgb(&hsv, &r, &g, &b);
                 } else {
                     // Truecolor mode - boost saturation slightly for vibrancy
                     // but keep original value for accuracy
-                    hsv.saturation = fmin(hsv.saturation * 1.15, 1.0);
-                    
-                    double r_d, g_d, b_d;
-                    hsv_to_rgb(&hsv, &r_d, &g_d, &b_d);
-                    r = (int)(r_d * 255);
-                    g = (int)(g_d * 255);
-                    b = (int)(b_d * 255);
+                    boost_saturation(pixel, &r, &g, &b);
                 }
                 
                 if (use_braille) {
-                    braille_str = get_braille_char(luma);
+                    braille_glyph = get_braille_char(luma);
                 } else {
-                    ascii_char = get_ascii_char_simple(luma);
+                    ascii_char = get_ascii_char(ramp, ramp_chars, luma);
                 }
             }
 
@@ -441,96 +781,578 @@ void print_image_with_options(image_t* image, args_t* args) {
             if (!use_braille && edge_magnitude >= edge_threshold) {
                 // Strong edges get edge characters
                 if (edge_magnitude >= edge_threshold * 1.5) {
-                    ascii_char = get_edge_char_by_angle(edge_angle);
+                    ascii_char = get_edge_char(sx, sy);
                 } else {
                     // Moderate edges: blend with texture
                     // Use slightly brighter character for edge areas
                     double boosted_luma = fmin(luma * 1.2, 1.0);
-                    ascii_char = get_ascii_char_simple(boosted_luma);
+                    ascii_char = get_ascii_char(ramp, ramp_chars, boosted_luma);
                 }
             }
             
-            // Output with 24-bit truecolor
+            // Store with 24-bit truecolor
             if (use_braille) {
-                printf("\x1b[38;2;%d;%d;%dm%s", r, g, b, braille_str);
+                cell_set(&cell_row[x], r, g, b, braille_glyph->bytes, braille_glyph->length);
             } else {
-                printf("\x1b[38;2;%d;%d;%dm%c", r, g, b, ascii_char);
+                char glyph[GLYPH_MAX_BYTES] = { ascii_char };
+                cell_set(&cell_row[x], r, g, b, glyph, 1);
+            }
+
+            if (use_hysteresis) {
+                hysteresis_apply(hold, y * width + x, luma, &cell_row[x],
+                                 holding ? &cell_grid_row(previous, y)[x] : NULL, holding);
             }
         }
-        printf("\n");
     }
 
-    printf("%s", RESET);
-    
-    // Cleanup
-    free(sobel_x);
-    free(sobel_y);
-    free(luminance_buffer);
-    free_image(&grayscale);
+    return 1;
+}
+
+void print_image_with_options(render_context_t* ctx, image_t* image, args_t* args) {
+    frame_buffer_reset(&ctx->output);
+    if (render_cells(ctx, image, args, NULL)) {
+        cell_grid_encode_full(&ctx->cells, &ctx->output);
+    }
+    frame_buffer_flush(&ctx->output, STDOUT_FILENO);
+}
+
+
+// Composed frames with distinct canvases, by content hash
+static int compare_hashes(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*) a, y = *(const uint64_t*) b;
+    return (x > y) - (x < y);
+}
+
+static int count_distinct_canvases(const gif_decoder_t* decoder, int* composed) {
+    uint64_t* hashes = malloc((size_t) decoder->frame_count * sizeof(*hashes));
+    int count = 0, distinct = 0;
+    if (!hashes) return 0;
+    for (int i = 0; i < decoder->frame_count; i++) {
+        if (decoder->frames[i].hash) hashes[count++] = decoder->frames[i].hash;
+    }
+    qsort(hashes, count, sizeof(*hashes), compare_hashes);
+    for (int i = 0; i < count; i++) {
+        distinct += i == 0 || hashes[i] != hashes[i - 1];
+    }
+    free(hashes);
+    *composed = count;
+    return distinct;
+}
+
+
+// Cells rendered from a canvas, by the canvas's content hash. Without glyph
+// hysteresis or stable contrast, rendering depends on nothing but the
+// prepared frame, so a later frame with the same canvas can copy them.
+#define KEPT_RENDERS 16
+
+typedef struct {
+    uint64_t hash;
+    cell_grid_t cells;
+} kept_render_t;
+
+static const cell_grid_t* find_render(const kept_render_t* renders, int count, uint64_t hash) {
+    for (int i = 0; hash && i < count; i++) {
+        if (renders[i].hash == hash) return &renders[i].cells;
+    }
+    return NULL;
+}
+
+
+// Keeps the cells of the first KEPT_RENDERS distinct canvases
+static void keep_render(kept_render_t* renders, int* count, uint64_t hash, const cell_grid_t* cells) {
+    if (!hash || *count == KEPT_RENDERS || find_render(renders, *count, hash)) return;
+    if (cell_grid_copy(&renders[*count].cells, cells)) {
+        renders[(*count)++].hash = hash;
+    }
+}
+
+
+// Heap allocations made so far by the player's own buffers
+static size_t player_allocations(const render_context_t* ctx, const cell_grid_t* shown, const frame_store_t* store,
+                                 const kept_render_t* renders) {
+    size_t count = ctx->scratch.heap_allocations + ctx->cells.heap_allocations + ctx->output.heap_allocations +
+                   ctx->hysteresis.heap_allocations + ctx->hysteresis.raw.heap_allocations +
+                   shown->heap_allocations + store->data.heap_allocations + store->heap_allocations;
+    for (int i = 0; i < KEPT_RENDERS; i++) {
+        count += renders[i].cells.heap_allocations;
+    }
+    return count;
+}
+
+
+// Follows a terminal resize when the size came from the terminal (no -D,
+// -mw or -mh). Returns 1 and the new size if it differs from `layout`. The
+// caller writes it into `layout` only once the workers reading it stopped.
+static int refit_terminal(const args_t* layout, size_t* width, size_t* height) {
+    if (!layout->fit_terminal || !try_get_terminal_size(width, height)) return 0;
+    return *width != layout->max_width || *height != layout->max_height;
+}
+
+
+// Brings `frame` up to date with the next prepared frame: a whole frame
+// replaces it and a patch is pasted over it, counting reallocations of
+// `frame` in `heap_allocations`. Returns 0 if there is no frame.
+static int apply_prepared_frame(image_t* frame, const prepared_frame_t* prepared, size_t* heap_allocations) {
+    const image_t* image = &prepared->image;
+    if (prepared->partial) {
+        if (!frame->data) return 0;
+        if (image->data) {
+            paste_image(frame, image, prepared->left, prepared->top);
+        }
+        return 1;
+    }
+
+    if (!image->data) {
+        free_image(frame);
+        return 0;
+    }
+    size_t samples = image->width * image->height * image->channels;
+    if (!frame->data || frame->width * frame->height * frame->channels != samples) {
+        free_image(frame);
+        frame->data = malloc(samples * sizeof(*frame->data));
+        (*heap_allocations)++;
+        if (!frame->data) {
+            fprintf(stderr, "Error: Failed to allocate animation frame!\n");
+            return 0;
+        }
+    }
+    memcpy(frame->data, image->data, samples * sizeof(*frame->data));
+    frame->width = image->width;
+    frame->height = image->height;
+    frame->channels = image->channels;
+    return 1;
+}
+
+
+// Frame store key of a patch: the frame's canvas over the canvas on screen
+static uint64_t patch_key(uint64_t hash, uint64_t shown_hash) {
+    return hash ? (hash * 0x9E3779B97F4A7C15ULL) ^ shown_hash : 0;
+}
+
+
+// Completes the frame store once it holds every frame. The first recorded
+// frame, stored whole, is stored again as the patch that wraps around to it
+// from `shown`, the last; if that fails, the whole frame replays as well.
+// Drops the worst-case slack left by the per-frame reservations.
+static void finish_frame_store(frame_store_t* store, int first_rendered, uint64_t key, const cell_grid_t* shown,
+                               cell_grid_t* scratch) {
+    if (first_rendered >= 0 && frame_store_apply(store, first_rendered, scratch) >= 0) {
+        frame_store_put(store, first_rendered, key, shown, scratch);
+    }
+    frame_store_shrink(store);
 }
 
 
 // Play animated GIF in terminal with ultra-smooth rendering
-void play_gif_animation(gif_animation_t* anim, args_t* args) {
-    if (!anim || anim->frame_count == 0) {
+void play_gif_animation(gif_source_t* source, args_t* args) {
+    if (!source || source->decoder.frame_count == 0) {
         fprintf(stderr, "Error: Invalid animation data!\n");
         return;
     }
     
-    printf("\x1b[2J\x1b[H"); // Clear screen and move cursor to home
-    
-    // Pre-process all frames once (resize and sharpen)
-    image_t* processed_frames = calloc(anim->frame_count, sizeof(image_t));
-    if (!processed_frames) {
-        fprintf(stderr, "Error: Failed to allocate processed frames!\n");
+    // Frames one loop shows. Any order other than every frame forwards
+    // seeks backwards, so the decoder snapshots its canvas every few frames
+    // to resume there instead of at the first frame. The snapshots take half
+    // of the window's memory.
+    playback_order_t order;
+    if (!playback_order_init(&order, args, source->decoder.frame_count)) {
         return;
     }
+    if ((order.length != source->decoder.frame_count || order.frames[0] != 0) &&
+        !gif_source_enable_seek(source)) {
+        fprintf(stderr, "Warning: Failed to allocate GIF seek index, seeking from the first frame\n");
+    }
     
-    // Pre-process frames (resize and sharpen once)
-    for (int i = 0; i < anim->frame_count; i++) {
-        // Resize first
-        processed_frames[i] = make_resized(&anim->frames[i], args->max_width, args->max_height, args->character_ratio);
-        
-        // Apply sharpening on resized frame (not original!)
-        if (processed_frames[i].data && args->sharpen_strength > 0.0) {
-            unsharp_mask(&processed_frames[i], args->sharpen_strength, 1.0);
-        }
+    double start_time = seconds_now();
+    printf("\x1b[2J\x1b[H"); // Clear screen and move cursor to home
+    
+    render_context_t ctx;
+    render_context_init(&ctx);
+    ctx.hysteresis.margin = args->hysteresis;
+    ctx.hysteresis.count_raw = args->debug_mode;
+    ctx.contrast.enabled = args->stable_contrast;
+    
+    // Size and options frames are prepared with; follows terminal resizes
+    args_t layout = *args;
+    
+    // Rendered frames, recorded over one pass through the animation as
+    // packed cell patches. Later loops replay them onto the grid on screen
+    // and encode from there, so they cost no rendering. The store gets half
+    // of --gif-memory; an animation that does not fit is streamed instead,
+    // rendering every frame on every loop. A single loop has nothing to
+    // replay and streams from the start. Frames are stored per position in
+    // the loop, so a frame that ping-pong shows twice has an entry for each.
+    size_t cache_cap = (size_t) args->gif_memory_mb * 1024 * 1024 / 2;
+    int playable_frames = source->decoder.playable_frames;
+    int frame_count = order.length;
+    long total_frames = args->loop_count > 0 ? (long) args->loop_count * frame_count : -1;
+    frame_store_t store = {0};
+    int streaming = args->loop_count == 1 || !frame_store_init(&store, frame_count);
+    int recording = !streaming;
+    long record_start = 0;      // position the store started recording at
+    int first_rendered = -1;    // stored whole until the loop closes
+    double replay_time = 0.0;
+    long frames_replayed = 0;
+    
+    // Grid on screen after the previous frame
+    cell_grid_t shown;
+    cell_grid_init(&shown);
+    
+    // Frames are decoded, resized and sharpened ahead of the playhead on
+    // --threads workers, so the first frame shows as soon as it is ready. The
+    // workers own `source` until stopped. With a frame store they only
+    // prepare one pass; streaming needs every loop.
+    frame_pipeline_t pipeline;
+    int pipeline_started = frame_pipeline_start(&pipeline, source, &layout, &order, args->threads, 0,
+                                                streaming ? total_frames : frame_count);
+    int worker_count = pipeline_started ? pipeline.worker_count : 0;
+    double first_frame_time = 0.0;
+    
+    // The frame being shown at output size. Workers prepare only the cells
+    // that changed, which are pasted over it.
+    image_t current = {0};
+    size_t cells_prepared = 0, cells_shown = 0;
+    
+    // A frame prepared as a repeat of the one before reuses its cells when
+    // `shown` was rendered from `current`, skipping the render. Frames are
+    // keyed by their canvas's hash: one that repeats an earlier canvas gets
+    // the pipeline's whole prepared copy, copies its kept cells when
+    // rendering is stateless, and shares its patch in the store. Any frame
+    // whose cells match the screen's writes nothing unless a redraw is due.
+    int current_shown = 0;
+    int reuse_renders = args->hysteresis <= 0.0 && !args->stable_contrast;
+    kept_render_t renders[KEPT_RENDERS];
+    int render_count = 0;
+    for (int i = 0; i < KEPT_RENDERS; i++) {
+        cell_grid_init(&renders[i].cells);
     }
+    uint64_t shown_hash = 0, first_hash = 0;
+    size_t frames_reused = 0, frames_unwritten = 0, preparations_reused = 0, renders_reused = 0;
     
     // Loop through frames and display with ultra-smooth timing
-    const int loop_count = 3; // Play 3 times
-    for (int loop = 0; loop < loop_count && !g_shutdown_requested; loop++) {
-        for (int i = 0; i < anim->frame_count && !g_shutdown_requested; i++) {
-            if (!processed_frames[i].data) continue;
+    // (loop_count 0 plays until interrupted)
+    int loop_count = args->loop_count;
+    int full_refresh = args->full_refresh;
+    int loops_played = 0;
+    long frames_shown = 0;
+    size_t bytes_written = 0;
+    size_t peak_store_bytes = 0;
+    
+    // Heap allocations per loop for --debug: the player's buffers, `current`,
+    // and the pipeline's with the source's, counting pipelines a resize stopped
+    size_t loop_allocations[3] = {0};
+    size_t retired_allocations = 0, frame_allocations = 0;
+    
+    // A terminal resize clears the screen and redraws the next frame in
+    // full. If the size follows the terminal, frames from the playhead on
+    // are prepared again at the new size from the decoded canvases still in
+    // the source's window, and the store is recorded again from there.
+    // Resize signals are coalesced per frame, so dragging the window edge
+    // re-lays out at most once per frame shown.
+    int relayouts = 0, resizes_shown = 0;
+    double resize_time = 0.0, resize_latency_total = 0.0, resize_latency_max = 0.0;
+    int clear_screen = 0;
+    
+    // Frames are paced against absolute deadlines (--speed, --fps). With
+    // --allow-frame-skip, a frame whose display slot has passed is dropped.
+    // A dropped frame leaves the screen behind the grid patches build on, so
+    // the frame after it redraws in full.
+    frame_scheduler_t scheduler;
+    frame_scheduler_init(&scheduler, args->speed, args->fps_cap, args->allow_frame_skip);
+    int stale = 0;
+    for (int loop = 0; pipeline_started && (loop_count == 0 || loop < loop_count); loop++) {
+        if (g_shutdown_requested) break;
+        size_t allocations_before = player_allocations(&ctx, &shown, &store, renders) + retired_allocations +
+                                    pipeline.heap_allocations + frame_allocations;
+        
+        for (int i = 0; i < frame_count && !g_shutdown_requested; i++) {
+            long position = (long) loop * frame_count + i;
+            if (recording && position == record_start + frame_count) {
+                // The store now holds every frame: stop the workers
+                finish_frame_store(&store, first_rendered, patch_key(first_hash, shown_hash), &shown, &ctx.cells);
+                frame_pipeline_stop(&pipeline);
+                free_image(&current);
+                recording = 0;
+            }
             
-            // Move cursor to home position (no clear, just overwrite)
-            printf("\x1b[H");
+            if (terminal_was_resized()) {
+                if (resize_time == 0.0) resize_time = seconds_now();
+                clear_screen = 1;
+                stale = 1;
+                size_t width, height;
+                if (refit_terminal(&layout, &width, &height)) {
+                    frame_pipeline_stop(&pipeline);
+                    retired_allocations += pipeline.heap_allocations;
+                    layout.max_width = width;
+                    layout.max_height = height;
+                    render_count = 0;
+                    if (!streaming) {
+                        frame_store_reset(&store, frame_count);
+                        first_rendered = -1;
+                        recording = 1;
+                        record_start = position;
+                    }
+                    pipeline_started = frame_pipeline_start(&pipeline, source, &layout, &order, args->threads,
+                                                            position, streaming ? total_frames : position + frame_count);
+                    if (!pipeline_started) break;
+                    relayouts++;
+                }
+            }
             
-            // Render frame directly (already pre-processed)
-            print_image(&processed_frames[i], args->edge_threshold, args->use_retro_colors, args->use_braille, args->use_grayscale);
+            // Periodic full redraws bound any drift between the terminal and
+            // the tracked grid (full_refresh 1 always redraws, 0 never does)
+            int redraw = frames_shown == 0 || stale || (full_refresh > 0 && frames_shown % full_refresh == 0);
+            int repeat = 0;
+            uint64_t hash = 0;
+            const char* bytes = NULL;
+            size_t length = 0;
+            long long duration = frame_scheduler_duration(&scheduler, source->decoder.frames[order.frames[i]].delay);
+            int drop = frame_scheduler_should_drop(&scheduler, duration);
             
-            // Flush output buffer immediately for smoother display
-            fflush(stdout);
+            if (recording || streaming) {
+                const prepared_frame_t* prepared = frame_pipeline_next(&pipeline);
+                if (prepared->playable_frames < playable_frames) {
+                    // A corrupt frame ended the animation early. Frames before
+                    // it were all played in order, so playback goes on from
+                    // this index of the order rebuilt without the rest.
+                    playable_frames = prepared->playable_frames;
+                    frame_pipeline_release(&pipeline);
+                    frame_pipeline_stop(&pipeline);
+                    retired_allocations += pipeline.heap_allocations;
+                    playback_order_free(&order);
+                    pipeline_started = playable_frames > 0 && playback_order_init(&order, args, playable_frames);
+                    if (!pipeline_started) break;
+                    frame_count = order.length;
+                    total_frames = loop_count > 0 ? (long) loop_count * frame_count : -1;
+                    long resume = (long) loop * frame_count + (i < frame_count ? i : frame_count);
+                    if (!streaming) {
+                        frame_store_reset(&store, frame_count);
+                        first_rendered = -1;
+                        record_start = resume;
+                    }
+                    pipeline_started = frame_pipeline_start(&pipeline, source, &layout, &order, args->threads,
+                                                            resume, streaming ? total_frames : resume + frame_count);
+                    if (!pipeline_started) break;
+                    i--;
+                    continue;
+                }
+                hash = prepared->hash;
+                repeat = prepared->partial && !prepared->image.data && current_shown;
+                int complete = apply_prepared_frame(&current, prepared, &frame_allocations);
+                if (complete && !prepared->kept) {
+                    frame_pipeline_keep(&pipeline, hash, &current);
+                }
+                preparations_reused += prepared->kept;
+                cells_prepared += prepared->kept ? 0 : prepared->image.width * prepared->image.height;
+                cells_shown += current.width * current.height;
+                frame_pipeline_release(&pipeline);
+                if (streaming && drop) {
+                    // Not rendered at all, so `shown` still matches the screen
+                    frame_scheduler_drop(&scheduler, duration);
+                    current_shown = 0;
+                    continue;
+                }
+                const cell_grid_t* earlier = repeat ? &shown
+                                           : complete && reuse_renders ? find_render(renders, render_count, hash)
+                                                                       : NULL;
+                int rendered = earlier ? cell_grid_copy(&ctx.cells, earlier)
+                                       : complete && render_cells(&ctx, &current, &layout, &shown);
+                frames_reused += repeat && rendered;
+                renders_reused += !repeat && earlier && rendered;
+                current_shown = rendered;
+                if (!rendered) continue;
+                if (!earlier && reuse_renders) {
+                    keep_render(renders, &render_count, hash, &ctx.cells);
+                }
+                repeat = cell_grid_equal(&shown, &ctx.cells);
+                
+                if (!streaming) {
+                    // Record the frame as a patch over the one before it. The
+                    // first has none yet, so it is stored whole.
+                    int stored = frame_store_put(&store, i, patch_key(hash, shown_hash),
+                                                 first_rendered < 0 ? NULL : &shown, &ctx.cells);
+                    if (first_rendered < 0) {
+                        first_rendered = i;
+                        first_hash = hash;
+                    }
+                    if (!stored || store.data.length > cache_cap) {
+                        // Over budget: drop the store and stream from this frame on
+                        peak_store_bytes = store.data.length;
+                        frame_store_free(&store);
+                        streaming = 1;
+                        recording = 0;
+                        frame_pipeline_extend(&pipeline, total_frames);
+                    }
+                }
+            } else {
+                // Replay: bring the grid on screen up to this frame
+                double replay_start = seconds_now();
+                if (!frame_store_has(&store, i) || !cell_grid_copy(&ctx.cells, &shown)) continue;
+                long written = frame_store_apply(&store, i, &ctx.cells);
+                if (written < 0) continue;
+                repeat = written == 0;
+                hash = source->decoder.frames[order.frames[i]].hash;
+                replay_time += seconds_now() - replay_start;
+                frames_replayed++;
+            }
+            
+            // Full redraw: move cursor to home position (no clear, just
+            // overwrite). Otherwise only the cells that differ from the
+            // frame on screen, and nothing for a repeat.
+            if (!drop) {
+                double encode_start = seconds_now();
+                frame_buffer_reset(&ctx.output);
+                if (redraw) {
+                    if (frame_buffer_reserve(&ctx.output, 3)) {
+                        frame_buffer_append(&ctx.output, "\x1b[H", 3);
+                    }
+                    cell_grid_encode_full(&ctx.cells, &ctx.output);
+                } else if (!repeat) {
+                    cell_grid_encode_delta(&shown, &ctx.cells, &ctx.output);
+                }
+                bytes = ctx.output.data;
+                length = ctx.output.length;
+                if (!recording && !streaming) replay_time += seconds_now() - encode_start;
+            }
             
-            // Frame delay with improved timing accuracy
-            // GIF delays are in centiseconds (1/100 second)
-            int delay_ms = anim->delays[i] * 10;
-            // Minimum 15ms for ultra-smooth 60+ FPS playback
-            if (delay_ms < 15) delay_ms = 15;
+            cell_grid_t previous = shown;
+            shown = ctx.cells;
+            ctx.cells = previous;
+            shown_hash = hash;
             
-            // Use nanosleep for more accurate timing than usleep
-            struct timespec ts;
-            ts.tv_sec = delay_ms / 1000;
-            ts.tv_nsec = (delay_ms % 1000) * 1000000;
-            nanosleep(&ts, NULL);
+            if (drop) {
+                frame_scheduler_drop(&scheduler, duration);
+                stale = 1;
+                continue;
+            }
+            if (!frame_scheduler_wait(&scheduler)) break;
+            
+            // Write the whole frame out in one go for smoother display
+            if (clear_screen) {
+                frame_buffer_write(STDOUT_FILENO, "\x1b[2J", 4);
+                clear_screen = 0;
+            }
+            if (length > 0) {
+                frame_buffer_write(STDOUT_FILENO, bytes, length);
+            } else {
+                frames_unwritten++;
+            }
+            frame_scheduler_presented(&scheduler, duration);
+            stale = 0;
+            bytes_written += length;
+            if (frames_shown++ == 0) {
+                first_frame_time = seconds_now() - start_time;
+            }
+            if (resize_time != 0.0) {
+                double latency = seconds_now() - resize_time;
+                resize_latency_total += latency;
+                if (latency > resize_latency_max) resize_latency_max = latency;
+                resizes_shown++;
+                resize_time = 0.0;
+            }
         }
+        
+        if (loop < 3) {
+            loop_allocations[loop] = player_allocations(&ctx, &shown, &store, renders) + retired_allocations +
+                                     pipeline.heap_allocations + frame_allocations - allocations_before;
+        }
+        loops_played++;
+    }
+    
+    if (recording && pipeline_started && pipeline.consumed == record_start + frame_count) {
+        finish_frame_store(&store, first_rendered, patch_key(first_hash, shown_hash), &shown, &ctx.cells);
     }
+    frame_pipeline_stop(&pipeline);
     
-    // Cleanup
-    for (int i = 0; i < anim->frame_count; i++) {
-        free_image(&processed_frames[i]);
+    // Hold the last frame for its full duration
+    if (frames_shown > 0 && !g_shutdown_requested) {
+        frame_scheduler_wait(&scheduler);
+    }
+    
+    if (args->debug_mode) {
+        size_t window_bytes = 0;
+        for (int i = 0; i < source->window_size; i++) {
+            const image_t* canvas = &source->window[i].canvas;
+            window_bytes += canvas->width * canvas->height * canvas->channels * sizeof(pixel_t);
+        }
+        fprintf(stderr, "[debug] time to first frame: %.1f ms, %d frame workers\n",
+                first_frame_time * 1000.0, worker_count);
+        fprintf(stderr, "[debug] render scratch high-water: %zu KB\n", ctx.scratch.high_water / 1024);
+        for (int loop = 0; loop < loops_played && loop < 3; loop++) {
+            fprintf(stderr, "[debug] loop %d: %zu heap allocations\n", loop + 1, loop_allocations[loop]);
+        }
+        fprintf(stderr, "[debug] GIF source: %zu frames decoded, %d-frame window, %zu KB\n",
+                source->decoded_frames, source->window_size, window_bytes / 1024);
+        if (source->decoder.keyframes) {
+            size_t canvas_bytes = (size_t) source->decoder.width * source->decoder.height * GIF_CHANNELS;
+            int keyframes = 0;
+            for (int i = 1; i <= source->decoder.frame_count / GIF_KEYFRAME_INTERVAL; i++) {
+                keyframes += source->decoder.keyframes[i].canvas != NULL;
+            }
+            fprintf(stderr, "[debug] seek index: %d keyframes every %d frames, %zu KB (%.1f%% of raw canvases), "
+                    "%zu KB with the window of %zu KB allowed\n",
+                    keyframes, source->decoder.keyframe_spacing, source->decoder.keyframe_bytes / 1024,
+                    keyframes ? 100.0 * source->decoder.keyframe_bytes / (keyframes * canvas_bytes) : 0.0,
+                    (source->decoder.keyframe_bytes + window_bytes) / 1024, source->memory_cap / 1024);
+        }
+        if (cells_shown > 0) {
+            fprintf(stderr, "[debug] changed regions: %.1f%% of frame cells resized\n",
+                    100.0 * cells_prepared / cells_shown);
+        }
+        if (streaming && args->loop_count == 1) {
+            fprintf(stderr, "[debug] frame store: not recorded for a single loop, streamed\n");
+        } else if (streaming) {
+            fprintf(stderr, "[debug] frame store: over %zu KB limit at %zu KB, streamed\n",
+                    cache_cap / 1024, peak_store_bytes / 1024);
+        } else {
+            fprintf(stderr, "[debug] frame store: %d frames, %zu cells in %zu KB packed, %d glyphs, %zu KB allocated\n",
+                    frame_count, store.cells, store.data.length / 1024, store.glyph_count,
+                    (store.data.capacity + sizeof(store) + frame_count * sizeof(stored_frame_t)) / 1024);
+        }
+        if (frames_replayed > 0) {
+            fprintf(stderr, "[debug] replay: %.1f us per frame to rebuild and encode\n",
+                    replay_time * 1e6 / frames_replayed);
+        }
+        int composed = 0;
+        int distinct = count_distinct_canvases(&source->decoder, &composed);
+        if (distinct > 0) {
+            fprintf(stderr, "[debug] dedup: %d distinct canvases in %d frames (%.2fx); from an earlier identical "
+                    "canvas, %zu frames were prepared and %zu rendered; %zu reused the cells before them, "
+                    "%zu stored patches were shared, %zu frames wrote nothing\n",
+                    distinct, composed, (double) composed / distinct, preparations_reused, renders_reused,
+                    frames_reused, store.shared, frames_unwritten);
+        }
+        const glyph_hysteresis_t* hold = &ctx.hysteresis;
+        if (hold->frames > 0 && hold->count_raw) {
+            double changed = (double) hold->changed / hold->frames;
+            double changed_raw = (double) hold->changed_raw / hold->frames;
+            fprintf(stderr, "[debug] glyph hysteresis: %.1f cells changed per frame, %.1f without (%.1f%% fewer)\n",
+                    changed, changed_raw, changed_raw > 0.0 ? 100.0 * (1.0 - changed / changed_raw) : 0.0);
+        }
+        const contrast_history_t* contrast = &ctx.contrast;
+        if (contrast->frames > 1) {
+            fprintf(stderr, "[debug] stable contrast: curve moves %.4f per frame, %.4f with per-frame curves, "
+                    "%zu scene cuts\n", contrast->drift / (contrast->frames - 1),
+                    contrast->drift_raw / (contrast->frames - 1), contrast->scene_cuts);
+        }
+        if (resizes_shown > 0) {
+            fprintf(stderr, "[debug] resizes: %d redrawn, %d re-laid out to %zux%zu, "
+                    "resize to redraw %.1f ms avg, %.1f ms max\n",
+                    resizes_shown, relayouts, layout.max_width, layout.max_height,
+                    resize_latency_total * 1000.0 / resizes_shown, resize_latency_max * 1000.0);
+        }
+        fprintf(stderr, "[debug] loops played: %d, %zu bytes/frame written\n",
+                loops_played, frames_shown ? bytes_written / (size_t) frames_shown : 0);
+        frame_scheduler_report(&scheduler);
+    }
+    frame_store_free(&store);
+    for (int i = 0; i < KEPT_RENDERS; i++) {
+        cell_grid_free(&renders[i].cells);
     }
-    free(processed_frames);
+    cell_grid_free(&shown);
+    free_image(&current);
+    playback_order_free(&order);
+    render_context_free(&ctx);
     
     printf("\n");
 }